@@ -0,0 +1,203 @@
+// bench/hymo_bench.cpp - Microbenchmarks over synthetic module trees
+//
+// Generates throwaway module trees with parameterized module, directory,
+// file and rule counts, then times the hot pipeline stages: the module
+// scan index, plan generation, HymoFS rule emission, content sync and
+// the magic mount tree builder. Results are printed as ns/op alongside
+// the process peak RSS. Builds on any Linux host via -DBUILD_BENCH=ON;
+// no kernel module or root required.
+//
+// Usage: hymo_bench [scratch_dir] [modules] [depth] [files_per_dir] [rules]
+
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "conf/config.hpp"
+#include "core/inventory.hpp"
+#include "core/planner.hpp"
+#include "core/sync.hpp"
+#include "mount/magic.hpp"
+#include "utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+namespace bench {
+
+struct TreeParams {
+    int modules = 8;
+    int depth = 3;
+    int dirs_per_level = 4;
+    int files_per_dir = 8;
+    int rules = 4;
+};
+
+// Populate dir with files_per_dir regular files and recurse into
+// dirs_per_level subdirectories until depth is exhausted
+static void make_tree(const fs::path& dir, int depth, int dirs_per_level, int files_per_dir) {
+    fs::create_directories(dir);
+    for (int f = 0; f < files_per_dir; f++) {
+        std::ofstream out(dir / ("file" + std::to_string(f) + ".so"));
+        out << "payload " << f << "\n";
+    }
+    if (depth <= 0)
+        return;
+    for (int d = 0; d < dirs_per_level; d++) {
+        make_tree(dir / ("dir" + std::to_string(d)), depth - 1, dirs_per_level, files_per_dir);
+    }
+}
+
+// Lay out params.modules synthetic modules under root, each with a
+// system/ subtree and per-path rules, and return their inventory entries
+static std::vector<Module> make_modules(const fs::path& root, const TreeParams& params) {
+    std::vector<Module> modules;
+    for (int m = 0; m < params.modules; m++) {
+        Module mod;
+        mod.id = "bench_module_" + std::to_string(m);
+        mod.source_path = root / mod.id;
+        mod.mode = "auto";
+        mod.name = "Bench module " + std::to_string(m);
+        mod.version = "1.0";
+
+        make_tree(mod.source_path / "system", params.depth, params.dirs_per_level,
+                  params.files_per_dir);
+
+        std::ofstream prop(mod.source_path / "module.prop");
+        prop << "id=" << mod.id << "\nname=" << mod.name << "\nversion=1.0\n";
+
+        // Alternate per-path modes so the planner's mixed-mode matcher
+        // has real work to do
+        for (int r = 0; r < params.rules; r++) {
+            ModuleRule rule;
+            rule.path = "/system/dir" + std::to_string(r % params.dirs_per_level);
+            rule.mode = (r % 2 == 0) ? "magic" : "overlay";
+            mod.rules.push_back(rule);
+        }
+        modules.push_back(mod);
+    }
+    return modules;
+}
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Run op until both the iteration floor and the time floor are met,
+// then report the mean wall time per call
+static void run_bench(const std::string& name, const std::function<void()>& op, int min_iters = 5,
+                      double min_seconds = 0.3) {
+    using clock = std::chrono::steady_clock;
+
+    // One warm-up pass so cold dentry/page caches don't skew the mean
+    op();
+
+    int iters = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        op();
+        iters++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (iters < min_iters || elapsed < min_seconds);
+
+    printf("%-24s %14.0f ns/op  %6d iters  peak_rss %ld KB\n", name.c_str(),
+           elapsed * 1e9 / iters, iters, peak_rss_kb());
+}
+
+static int run(const fs::path& scratch, const TreeParams& params) {
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+
+    fs::path storage_root = scratch / "modules";
+    std::vector<Module> modules = make_modules(storage_root, params);
+
+    long per_module =
+        params.files_per_dir;  // files at depth 0; grows geometrically below
+    for (int d = 1, dirs = params.dirs_per_level; d <= params.depth;
+         d++, dirs *= params.dirs_per_level) {
+        per_module += (long)dirs * params.files_per_dir;
+    }
+    printf("hymo_bench: %d modules, depth %d, %ld files/module, %d rules/module\n",
+           params.modules, params.depth, per_module, params.rules);
+
+    Config config;
+    config.moduledir = storage_root;
+
+    ModuleScanIndex index;
+    run_bench("scan_index", [&] { index = build_module_scan_index(config, modules, storage_root); });
+
+    MountPlan plan;
+    run_bench("generate_plan",
+              [&] { plan = generate_plan(config, modules, storage_root, index); });
+
+    // Off-device there is no HymoFS kernel, so generate_plan never
+    // classifies modules as hymofs; claim them all here so rule emission
+    // (the compute half of the old update path) runs over the full set.
+    // apply_hymofs_rules is deliberately not benchmarked: it is pure
+    // ioctl submission.
+    MountPlan emit_template = plan;
+    emit_template.hymofs_module_ids.clear();
+    for (const auto& mod : modules) {
+        emit_template.hymofs_module_ids.push_back(mod.id);
+    }
+    run_bench("emit_hymofs_rules", [&] {
+        MountPlan scratch_plan = emit_template;
+        HymoFSRuleSet rules = emit_hymofs_rules(config, modules, storage_root, scratch_plan, index);
+        (void)rules;
+    });
+
+    // Sync into a separate storage root, wiping it each iteration so
+    // every pass measures a full cold copy rather than a manifest no-op
+    fs::path sync_root = scratch / "sync_storage";
+    Config sync_config = config;
+    sync_config.sync_threads = 1;  // serial: measure copy cost, not scheduling
+    run_bench(
+        "perform_sync",
+        [&] {
+            fs::remove_all(sync_root);
+            fs::create_directories(sync_root);
+            perform_sync(modules, sync_root, sync_config);
+        },
+        3, 0.3);
+
+    std::vector<fs::path> module_paths;
+    for (const auto& mod : modules) {
+        module_paths.push_back(mod.source_path);
+    }
+    run_bench("magic_tree_build",
+              [&] { build_magic_tree_for_bench(module_paths, {}); });
+
+    fs::remove_all(scratch);
+    return 0;
+}
+
+}  // namespace bench
+}  // namespace hymo
+
+int main(int argc, char* argv[]) {
+    hymo::Logger::getInstance().init(false, false, "");
+
+    fs::path scratch =
+        argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "hymo_bench";
+
+    hymo::bench::TreeParams params;
+    if (argc > 2)
+        params.modules = std::atoi(argv[2]);
+    if (argc > 3)
+        params.depth = std::atoi(argv[3]);
+    if (argc > 4)
+        params.files_per_dir = std::atoi(argv[4]);
+    if (argc > 5)
+        params.rules = std::atoi(argv[5]);
+
+    return hymo::bench::run(scratch, params);
+}
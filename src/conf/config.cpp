@@ -34,54 +34,93 @@ Config Config::from_file(const fs::path& path) {
     buffer << file.rdbuf();
     std::string json_str = buffer.str();
 
-    try {
-        json::Value root = json::parse(json_str);
-        if (root.type == json::Type::Object) {
-            const auto& o = root.as_object();
-
-            if (o.count("moduledir"))
-                config.moduledir = o.at("moduledir").as_string();
-            if (o.count("tempdir"))
-                config.tempdir = o.at("tempdir").as_string();
-            if (o.count("mountsource"))
-                config.mountsource = o.at("mountsource").as_string();
-            if (o.count("debug"))
-                config.debug = o.at("debug").as_bool();
-            if (o.count("verbose"))
-                config.verbose = o.at("verbose").as_bool();
-            if (o.count("fs_type"))
-                config.fs_type = filesystem_type_from_string(o.at("fs_type").as_string());
-            if (o.count("disable_umount"))
-                config.disable_umount = o.at("disable_umount").as_bool();
-            if (o.count("enable_nuke"))
-                config.enable_nuke = o.at("enable_nuke").as_bool();
-            if (o.count("ignore_protocol_mismatch"))
-                config.ignore_protocol_mismatch = o.at("ignore_protocol_mismatch").as_bool();
-            if (o.count("enable_kernel_debug"))
-                config.enable_kernel_debug = o.at("enable_kernel_debug").as_bool();
-            if (o.count("enable_stealth"))
-                config.enable_stealth = o.at("enable_stealth").as_bool();
-            if (o.count("hymofs_enabled"))
-                config.hymofs_enabled = o.at("hymofs_enabled").as_bool();
-            if (o.count("mirror_path"))
-                config.mirror_path = o.at("mirror_path").as_string();
-            if (o.count("uname_release"))
-                config.uname_release = o.at("uname_release").as_string();
-            if (o.count("uname_version"))
-                config.uname_version = o.at("uname_version").as_string();
-            if (o.count("mount_stage"))
-                config.mount_stage = o.at("mount_stage").as_string();
-
-            if (o.count("partitions") && o.at("partitions").type == json::Type::Array) {
-                for (const auto& p : o.at("partitions").as_array()) {
-                    if (p.type == json::Type::String) {
-                        config.partitions.push_back(p.as_string());
-                    }
-                }
+    // Pull-parsed straight off the buffer: the config is read on every
+    // CLI invocation and a DOM tree costs more than the whole load
+    json::Reader reader(json_str);
+    bool ok = reader.next() == json::Event::ObjectBegin;
+    while (ok) {
+        json::Event ev = reader.next();
+        if (ev == json::Event::ObjectEnd)
+            break;
+        if (ev != json::Event::Key) {
+            ok = false;
+            break;
+        }
+        std::string_view key = reader.token();
+
+        if (key == "partitions") {
+            if (reader.next() != json::Event::ArrayBegin) {
+                ok = false;
+                break;
+            }
+            json::Event item;
+            while ((item = reader.next()) == json::Event::String) {
+                config.partitions.push_back(json::unescape(reader.token()));
             }
+            ok = item == json::Event::ArrayEnd;
+            continue;
         }
-    } catch (const std::exception& e) {
-        LOG_WARN("Failed to parse config JSON: " + std::string(e.what()));
+
+        json::Event val = reader.next();
+        if (val == json::Event::String) {
+            std::string s = json::unescape(reader.token());
+            if (key == "moduledir")
+                config.moduledir = s;
+            else if (key == "tempdir")
+                config.tempdir = s;
+            else if (key == "mountsource")
+                config.mountsource = s;
+            else if (key == "fs_type")
+                config.fs_type = filesystem_type_from_string(s);
+            else if (key == "mirror_path")
+                config.mirror_path = s;
+            else if (key == "uname_release")
+                config.uname_release = s;
+            else if (key == "uname_version")
+                config.uname_version = s;
+            else if (key == "mount_stage")
+                config.mount_stage = s;
+        } else if (val == json::Event::Bool) {
+            bool b = reader.boolean();
+            if (key == "debug")
+                config.debug = b;
+            else if (key == "verbose")
+                config.verbose = b;
+            else if (key == "erofs_deferred_rebuild")
+                config.erofs_deferred_rebuild = b;
+            else if (key == "loop_direct_io")
+                config.loop_direct_io = b;
+            else if (key == "disable_umount")
+                config.disable_umount = b;
+            else if (key == "enable_nuke")
+                config.enable_nuke = b;
+            else if (key == "ignore_protocol_mismatch")
+                config.ignore_protocol_mismatch = b;
+            else if (key == "enable_kernel_debug")
+                config.enable_kernel_debug = b;
+            else if (key == "enable_stealth")
+                config.enable_stealth = b;
+            else if (key == "hymofs_enabled")
+                config.hymofs_enabled = b;
+            else if (key == "prefetch")
+                config.prefetch = b;
+        } else if (val == json::Event::Number) {
+            int n = (int)reader.number();
+            if (key == "sync_threads")
+                config.sync_threads = n;
+            else if (key == "prefetch_budget_mb")
+                config.prefetch_budget_mb = n;
+            else if (key == "image_max_size_mb")
+                config.image_max_size_mb = n;
+        } else if (val == json::Event::ObjectBegin || val == json::Event::ArrayBegin) {
+            // Unknown or mistyped key; step over whatever it holds
+            ok = reader.skip_container();
+        } else if (val == json::Event::Error || val == json::Event::End) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        LOG_WARN("Failed to parse config JSON");
     }
 
     config.module_modes = load_module_modes();
@@ -106,12 +145,18 @@ bool Config::save_to_file(const fs::path& path) const {
     root["debug"] = json::Value(debug);
     root["verbose"] = json::Value(verbose);
     root["fs_type"] = json::Value(filesystem_type_to_string(fs_type));
+    root["erofs_deferred_rebuild"] = json::Value(erofs_deferred_rebuild);
+    root["loop_direct_io"] = json::Value(loop_direct_io);
     root["disable_umount"] = json::Value(disable_umount);
     root["enable_nuke"] = json::Value(enable_nuke);
     root["ignore_protocol_mismatch"] = json::Value(ignore_protocol_mismatch);
     root["enable_kernel_debug"] = json::Value(enable_kernel_debug);
     root["enable_stealth"] = json::Value(enable_stealth);
     root["hymofs_enabled"] = json::Value(hymofs_enabled);
+    root["sync_threads"] = json::Value(sync_threads);
+    root["prefetch"] = json::Value(prefetch);
+    root["prefetch_budget_mb"] = json::Value(prefetch_budget_mb);
+    root["image_max_size_mb"] = json::Value(image_max_size_mb);
     if (!mirror_path.empty())
         root["mirror_path"] = json::Value(mirror_path);
     if (!uname_release.empty())
@@ -166,17 +211,21 @@ std::map<std::string, std::string> load_module_modes() {
     std::ifstream file(mode_file);
     std::stringstream buffer;
     buffer << file.rdbuf();
-
-    try {
-        auto root = json::parse(buffer.str());
-        if (root.type == json::Type::Object) {
-            for (const auto& [key, val] : root.as_object()) {
-                if (val.type == json::Type::String) {
-                    modes[key] = val.as_string();
-                }
+    std::string text = buffer.str();
+
+    json::Reader reader(text);
+    if (reader.next() == json::Event::ObjectBegin) {
+        json::Event ev;
+        while ((ev = reader.next()) == json::Event::Key) {
+            std::string id = json::unescape(reader.token());
+            json::Event val = reader.next();
+            if (val == json::Event::String) {
+                modes[id] = json::unescape(reader.token());
+            } else if (val == json::Event::ObjectBegin || val == json::Event::ArrayBegin) {
+                if (!reader.skip_container())
+                    break;
             }
         }
-    } catch (...) {
     }
 
     return modes;
@@ -192,25 +241,40 @@ std::map<std::string, std::vector<ModuleRuleConfig>> load_module_rules() {
     std::ifstream file(rules_file);
     std::stringstream buffer;
     buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    json::Reader reader(text);
+    if (reader.next() != json::Event::ObjectBegin)
+        return rules;
 
-    try {
-        auto root = json::parse(buffer.str());
-        if (root.type == json::Type::Object) {
-            for (const auto& [mod_id, list] : root.as_object()) {
-                if (list.type == json::Type::Array) {
-                    for (const auto& rule : list.as_array()) {
-                        if (rule.type == json::Type::Object) {
-                            const auto& ro = rule.as_object();
-                            if (ro.count("path") && ro.count("mode")) {
-                                rules[mod_id].push_back(
-                                    {ro.at("path").as_string(), ro.at("mode").as_string()});
-                            }
-                        }
-                    }
-                }
+    json::Event ev;
+    while ((ev = reader.next()) == json::Event::Key) {
+        std::string mod_id = json::unescape(reader.token());
+        if (reader.next() != json::Event::ArrayBegin) {
+            break;
+        }
+
+        json::Event item;
+        while ((item = reader.next()) == json::Event::ObjectBegin) {
+            std::string path, mode;
+            json::Event field;
+            while ((field = reader.next()) == json::Event::Key) {
+                std::string_view name = reader.token();
+                if (reader.next() != json::Event::String)
+                    break;
+                if (name == "path")
+                    path = json::unescape(reader.token());
+                else if (name == "mode")
+                    mode = json::unescape(reader.token());
+            }
+            if (field != json::Event::ObjectEnd)
+                break;
+            if (!path.empty() && !mode.empty()) {
+                rules[mod_id].push_back({path, mode});
             }
         }
-    } catch (...) {
+        if (item != json::Event::ArrayEnd)
+            break;
     }
 
     return rules;
@@ -49,6 +49,9 @@ struct Config {
     bool debug = false;
     bool verbose = false;
     FilesystemType fs_type = FilesystemType::AUTO;
+    bool erofs_deferred_rebuild = false;  // Stale EROFS image: boot on ext4, rebuild in background
+    bool loop_direct_io = true;           // Attach image loop devices with direct I/O
+    int image_max_size_mb = 2048;         // Cap for the auto-sized/grown ext4 modules.img
     bool disable_umount = false;
     bool enable_nuke = true;
     bool ignore_protocol_mismatch = false;
@@ -59,6 +62,9 @@ struct Config {
     std::string uname_release;
     std::string uname_version;
     std::string mount_stage = "metamount";  // "post-fs-data", "metamount", "services"
+    int sync_threads = 0;                   // Sync worker count; 0 = one per core, 1 = serial
+    bool prefetch = false;                  // Warm the page cache for mounted content after boot
+    int prefetch_budget_mb = 128;           // Upper bound on prefetched bytes per boot
     std::vector<std::string> partitions;
     std::map<std::string, std::string> module_modes;
     std::map<std::string, std::vector<ModuleRuleConfig>> module_rules;
@@ -0,0 +1,246 @@
+// core/daemon.cpp - Resident command server over a UNIX socket
+#include "daemon.hpp"
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "../defs.hpp"
+#include "../mount/hymofs.hpp"
+#include "../utils.hpp"
+#include "hotmount.hpp"
+#include "modules.hpp"
+#include "path_index.hpp"
+#include "storage.hpp"
+#include "telemetry.hpp"
+#include "timings.hpp"
+#include "webui.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+static const char* DAEMON_SOCKET_NAME = "daemon.sock";
+
+// Dashboard polls partitions every couple of seconds; detection walks
+// /proc/mounts each time, so keep the last answer warm briefly.
+static constexpr auto PARTITION_CACHE_TTL = std::chrono::seconds(2);
+
+static std::string cached_partitions_json() {
+    static std::string cached;
+    static std::chrono::steady_clock::time_point stamp;
+
+    auto now = std::chrono::steady_clock::now();
+    if (cached.empty() || now - stamp > PARTITION_CACHE_TTL) {
+        cached = export_partitions_json();
+        stamp = now;
+    }
+    return cached;
+}
+
+// Handle one request line. Returns false for commands the daemon does
+// not serve; the client then falls back to local execution.
+static bool dispatch(const Config& config, const std::string& request, std::string& payload) {
+    if (request == "ping") {
+        payload = "pong";
+        return true;
+    }
+    if (request == "api system") {
+        payload = export_system_info_json();
+        return true;
+    }
+    if (request == "api storage") {
+        payload = export_storage_status_json();
+        return true;
+    }
+    if (request == "api mount-stats") {
+        payload = export_mount_stats_json();
+        return true;
+    }
+    if (request == "api partitions") {
+        payload = cached_partitions_json();
+        return true;
+    }
+    if (request == "api timings") {
+        payload = export_timings_json();
+        return true;
+    }
+    if (request == "api conflicts") {
+        payload = export_conflicts_json(config);
+        return true;
+    }
+    if (request == "api hotmount-status") {
+        payload = export_hotmount_status_json();
+        return true;
+    }
+    if (request == "api history") {
+        payload = export_telemetry_history_json();
+        return true;
+    }
+    if (request == "module list") {
+        payload = export_module_list_json(config);
+        return true;
+    }
+    if (request == "hymofs list") {
+        payload = export_hymofs_rules_json();
+        return true;
+    }
+    return false;
+}
+
+static fs::path daemon_socket_path() {
+    return fs::path(RUN_DIR) / DAEMON_SOCKET_NAME;
+}
+
+static bool read_request_line(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (line.size() < 4096) {
+        ssize_t n = read(fd, &c, 1);
+        if (n <= 0)
+            return false;
+        if (c == '\n')
+            return true;
+        line += c;
+    }
+    return false;
+}
+
+static bool write_all(int fd, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = write(fd, data.data() + off, data.size() - off);
+        if (n <= 0)
+            return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+int run_daemon(const Config& config) {
+    std::error_code ec;
+    fs::create_directories(RUN_DIR, ec);
+
+    fs::path sock_path = daemon_socket_path();
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        LOG_ERROR("Daemon: socket() failed: " + std::string(strerror(errno)));
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (sock_path.string().size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Daemon: socket path too long: " + sock_path.string());
+        close(listen_fd);
+        return 1;
+    }
+    strncpy(addr.sun_path, sock_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Stale socket from a previous run; bind() fails on an existing path
+    unlink(sock_path.c_str());
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("Daemon: bind() failed: " + std::string(strerror(errno)));
+        close(listen_fd);
+        return 1;
+    }
+    chmod(sock_path.c_str(), 0600);
+
+    if (listen(listen_fd, 8) != 0) {
+        LOG_ERROR("Daemon: listen() failed: " + std::string(strerror(errno)));
+        close(listen_fd);
+        unlink(sock_path.c_str());
+        return 1;
+    }
+
+    // A client vanishing mid-reply must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+
+    // Touching HymoFS here caches the anon fd for the process lifetime,
+    // so later queries skip the reboot-syscall handshake
+    HymoFS::is_available();
+
+    LOG_INFO("Daemon listening on " + sock_path.string());
+
+    while (true) {
+        int client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("Daemon: accept() failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        std::string request;
+        if (read_request_line(client_fd, request)) {
+            std::string payload;
+            if (dispatch(config, request, payload)) {
+                write_all(client_fd, "OK\n" + payload);
+            } else {
+                LOG_DEBUG("Daemon: declined request: " + request);
+                write_all(client_fd, "ERR unsupported\n");
+            }
+        }
+        close(client_fd);
+    }
+
+    close(listen_fd);
+    unlink(sock_path.c_str());
+    return 1;
+}
+
+bool daemon_request(const std::string& request, std::string& response) {
+    fs::path sock_path = daemon_socket_path();
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (sock_path.string().size() >= sizeof(addr.sun_path)) {
+        close(fd);
+        return false;
+    }
+    strncpy(addr.sun_path, sock_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Never hang the CLI on a wedged daemon; fall back to local execution
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (!write_all(fd, request + "\n")) {
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+
+    std::string raw;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        raw.append(buf, (size_t)n);
+    }
+    close(fd);
+
+    const std::string ok_prefix = "OK\n";
+    if (raw.compare(0, ok_prefix.size(), ok_prefix) != 0)
+        return false;
+
+    response = raw.substr(ok_prefix.size());
+    return true;
+}
+
+}  // namespace hymo
@@ -0,0 +1,23 @@
+// core/daemon.hpp - Resident command server over a UNIX socket
+#pragma once
+
+#include <string>
+#include "../conf/config.hpp"
+
+namespace hymo {
+
+// Run the resident command server. Binds a UNIX socket under RUN_DIR and
+// answers read-only api/module/hymofs queries without a fork/exec per
+// request, keeping the config and HymoFS fd warm between polls.
+// Blocks until the process is terminated; returns an exit code on
+// setup failure.
+int run_daemon(const Config& config);
+
+// Thin-client side: forward one request line to a running daemon.
+// Returns true and fills `response` with the payload when the daemon is
+// up and handled the request; returns false when no daemon is listening
+// or it declined the request, in which case the caller should execute
+// the command locally as before.
+bool daemon_request(const std::string& request, std::string& response);
+
+}  // namespace hymo
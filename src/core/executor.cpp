@@ -1,10 +1,19 @@
 // core/executor.cpp - Mount execution implementation
 #include "executor.hpp"
+#include <sys/wait.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 #include "../defs.hpp"
 #include "../mount/magic.hpp"
 #include "../mount/overlay.hpp"
 #include "../utils.hpp"
+#include "prefetch.hpp"
+#include "timings.hpp"
 
 namespace hymo {
 
@@ -23,6 +32,7 @@ static fs::path extract_module_root(const fs::path& partition_path) {
 }
 
 ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool hymofs_active) {
+    ScopedTimer timer("execute_plan");
     if (!plan.hymofs_module_ids.empty()) {
         LOG_INFO("HymoFS modules handled by Fast Path controller.");
     }
@@ -32,8 +42,20 @@ ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool h
     std::vector<std::string> final_overlay_ids = plan.overlay_module_ids;
     std::vector<std::string> fallback_ids;
 
-    // Execute Overlay Operations
-    for (const auto& op : plan.overlay_ops) {
+    // Execute Overlay Operations. Targets (/system, /vendor, ...) are
+    // disjoint mount points, so each op gets its own worker and only the
+    // fallback bookkeeping is shared. Joining all workers below acts as
+    // the barrier before the magic-mount phase, which may consume
+    // fallback entries produced here.
+    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
+    for (const auto& part : config.partitions) {
+        all_partitions.push_back(part);
+    }
+
+    std::mutex fallback_mutex;
+
+    auto mount_one_overlay = [&](const OverlayOperation& op) {
+        ScopedTimer op_timer("overlay:" + op.target);
         std::vector<std::string> lowerdir_strings;
         for (const auto& p : op.lowerdirs) {
             lowerdir_strings.push_back(p.string());
@@ -42,16 +64,12 @@ ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool h
         LOG_DEBUG("Mounting " + op.target + " [OVERLAY] (" +
                   std::to_string(lowerdir_strings.size()) + " layers)");
 
-        std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
-        for (const auto& part : config.partitions) {
-            all_partitions.push_back(part);
-        }
-
         if (!mount_overlay(op.target, lowerdir_strings, config.mountsource, std::nullopt,
                            std::nullopt, config.disable_umount, all_partitions)) {
             LOG_WARN("OverlayFS failed for " + op.target + ". Triggering fallback.");
 
             // Fallback: Add all involved modules to magic queue
+            std::lock_guard<std::mutex> lock(fallback_mutex);
             for (const auto& layer_path : op.lowerdirs) {
                 fs::path root = extract_module_root(layer_path);
                 if (!root.empty()) {
@@ -63,6 +81,46 @@ ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool h
                 }
             }
         }
+    };
+
+    // Hottest targets first, per the profile hints the prefetch worker
+    // persisted last boot. Ops run concurrently anyway, so this only
+    // biases who gets the first CPU and I/O slots; precedence within an
+    // op's lowerdir stack is untouched.
+    std::vector<const OverlayOperation*> ordered_ops;
+    ordered_ops.reserve(plan.overlay_ops.size());
+    for (const auto& op : plan.overlay_ops) {
+        ordered_ops.push_back(&op);
+    }
+    std::map<std::string, int> priorities = load_module_priorities();
+    if (!priorities.empty()) {
+        auto op_score = [&priorities](const OverlayOperation* op) {
+            int best = 0;
+            for (const auto& layer : op->lowerdirs) {
+                auto it = priorities.find(extract_id(layer));
+                if (it != priorities.end() && it->second > best) {
+                    best = it->second;
+                }
+            }
+            return best;
+        };
+        std::stable_sort(ordered_ops.begin(), ordered_ops.end(),
+                         [&op_score](const OverlayOperation* a, const OverlayOperation* b) {
+                             return op_score(a) > op_score(b);
+                         });
+    }
+
+    if (ordered_ops.size() > 1) {
+        std::vector<std::thread> workers;
+        workers.reserve(ordered_ops.size());
+        for (const OverlayOperation* op : ordered_ops) {
+            workers.emplace_back(mount_one_overlay, std::cref(*op));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    } else if (!ordered_ops.empty()) {
+        mount_one_overlay(*ordered_ops.front());
     }
 
     // Adjust ID lists based on fallbacks
@@ -116,6 +174,7 @@ ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool h
             LOG_ERROR("Magic Mount aborted: temp dir prepare failed");
             final_magic_ids.clear();
         } else {
+            ScopedTimer magic_timer("magic_mount");
             if (!mount_partitions(tempdir, magic_queue, config.mountsource, config.partitions,
                                   config.disable_umount)) {
                 LOG_ERROR("Magic Mount critical failure");
@@ -138,4 +197,147 @@ ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool h
     return ExecutionResult{final_overlay_ids, final_magic_ids};
 }
 
+// Pull work owned entirely by deferred modules out of `plan` into a
+// second plan. An overlay op only moves when every layer comes from a
+// deferred module: overlayfs mounts a target once, so one critical layer
+// pins the whole stack to the critical phase.
+static MountPlan extract_deferred_plan(MountPlan& plan, const std::set<std::string>& deferred_ids) {
+    MountPlan deferred;
+
+    std::vector<OverlayOperation> critical_ops;
+    std::set<std::string> critical_layer_ids;
+    std::set<std::string> deferred_layer_ids;
+
+    for (auto& op : plan.overlay_ops) {
+        bool all_deferred = !op.lowerdirs.empty();
+        for (const auto& layer : op.lowerdirs) {
+            if (deferred_ids.find(extract_id(layer)) == deferred_ids.end()) {
+                all_deferred = false;
+                break;
+            }
+        }
+
+        auto& id_set = all_deferred ? deferred_layer_ids : critical_layer_ids;
+        for (const auto& layer : op.lowerdirs) {
+            id_set.insert(extract_id(layer));
+        }
+
+        if (all_deferred) {
+            deferred.overlay_ops.push_back(std::move(op));
+        } else {
+            critical_ops.push_back(std::move(op));
+        }
+    }
+    plan.overlay_ops = std::move(critical_ops);
+
+    // A module stays in the critical ID list while any critical op still
+    // carries one of its layers
+    std::vector<std::string> critical_overlay_ids;
+    for (auto& id : plan.overlay_module_ids) {
+        if (deferred_layer_ids.count(id) && !critical_layer_ids.count(id)) {
+            deferred.overlay_module_ids.push_back(std::move(id));
+        } else {
+            critical_overlay_ids.push_back(std::move(id));
+        }
+    }
+    plan.overlay_module_ids = std::move(critical_overlay_ids);
+
+    std::vector<fs::path> critical_magic_paths;
+    for (auto& path : plan.magic_module_paths) {
+        if (path.has_filename() && deferred_ids.count(path.filename().string())) {
+            deferred.magic_module_paths.push_back(std::move(path));
+        } else {
+            critical_magic_paths.push_back(std::move(path));
+        }
+    }
+    plan.magic_module_paths = std::move(critical_magic_paths);
+
+    std::vector<std::string> critical_magic_ids;
+    for (auto& id : plan.magic_module_ids) {
+        if (deferred_ids.count(id)) {
+            deferred.magic_module_ids.push_back(std::move(id));
+        } else {
+            critical_magic_ids.push_back(std::move(id));
+        }
+    }
+    plan.magic_module_ids = std::move(critical_magic_ids);
+
+    // HymoFS rule submission is one batched ioctl and stays critical
+    return deferred;
+}
+
+// Run the deferred plan in a detached grandchild; mounts land in the
+// shared namespace, so the worker's bind/overlay mounts appear system-wide
+// a few seconds after the critical phase returned
+static void spawn_deferred_mount_worker(const MountPlan& deferred, const Config& config,
+                                        bool hymofs_active) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_WARN("Deferred mount phase: fork failed: " + std::string(strerror(errno)) +
+                 ". Running inline.");
+        execute_plan(deferred, config, hymofs_active);
+        return;
+    }
+    if (pid > 0) {
+        // Reap the intermediate child; the grandchild is init's problem
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+
+    if (fork() == 0) {
+        setsid();
+        execute_plan(deferred, config, hymofs_active);
+    }
+    _exit(0);
+}
+
+ExecutionResult execute_plan_phased(const MountPlan& plan, const Config& config,
+                                    bool hymofs_active, const std::vector<Module>& modules) {
+    std::set<std::string> deferred_ids;
+    for (const auto& mod : modules) {
+        if (mod.deferred) {
+            deferred_ids.insert(mod.id);
+        }
+    }
+
+    if (deferred_ids.empty()) {
+        return execute_plan(plan, config, hymofs_active);
+    }
+
+    MountPlan critical = plan;
+    MountPlan deferred = extract_deferred_plan(critical, deferred_ids);
+
+    if (deferred.overlay_ops.empty() && deferred.magic_module_paths.empty()) {
+        return execute_plan(critical, config, hymofs_active);
+    }
+
+    ExecutionResult result = execute_plan(critical, config, hymofs_active);
+
+    LOG_INFO("Deferring " + std::to_string(deferred.overlay_ops.size()) + " overlay ops and " +
+             std::to_string(deferred.magic_module_paths.size()) +
+             " magic modules to background phase.");
+    spawn_deferred_mount_worker(deferred, config, hymofs_active);
+
+    // Report the deferred modules as mounted: the worker completes within
+    // seconds and logs its own failures. Fallback shuffling inside the
+    // worker is not reflected here.
+    result.overlay_module_ids.insert(result.overlay_module_ids.end(),
+                                     deferred.overlay_module_ids.begin(),
+                                     deferred.overlay_module_ids.end());
+    result.magic_module_ids.insert(result.magic_module_ids.end(),
+                                   deferred.magic_module_ids.begin(),
+                                   deferred.magic_module_ids.end());
+
+    std::sort(result.overlay_module_ids.begin(), result.overlay_module_ids.end());
+    result.overlay_module_ids.erase(
+        std::unique(result.overlay_module_ids.begin(), result.overlay_module_ids.end()),
+        result.overlay_module_ids.end());
+    std::sort(result.magic_module_ids.begin(), result.magic_module_ids.end());
+    result.magic_module_ids.erase(
+        std::unique(result.magic_module_ids.begin(), result.magic_module_ids.end()),
+        result.magic_module_ids.end());
+
+    return result;
+}
+
 }  // namespace hymo
@@ -15,4 +15,11 @@ struct ExecutionResult {
 
 ExecutionResult execute_plan(const MountPlan& plan, const Config& config, bool hymofs_active);
 
+// Two-phase variant: mounts owned entirely by modules marked
+// priority=deferred are handed to a detached background worker so only
+// the boot-critical work sits on the do_mount critical path. Falls back
+// to plain execute_plan when no module opts in.
+ExecutionResult execute_plan_phased(const MountPlan& plan, const Config& config,
+                                    bool hymofs_active, const std::vector<Module>& modules);
+
 } // namespace hymo
@@ -0,0 +1,202 @@
+// core/hotmount.cpp - Pipelined hot-mount engine implementation
+#include "hotmount.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../defs.hpp"
+#include "../dirwalk.hpp"
+#include "../mount/hymofs.hpp"
+#include "../utils.hpp"
+#include "json_writer.hpp"
+
+namespace hymo {
+
+// Producer chunk size and queue bound. Chunks keep locking off the
+// per-entry path; the bound stops a fast walk from buffering a huge
+// module ahead of a slow kernel.
+static constexpr size_t HOTMOUNT_CHUNK = 512;
+static constexpr size_t HOTMOUNT_MAX_QUEUED = 16;
+
+static const char* HOTMOUNT_STATUS_FILE_NAME = "hotmount_status.tsv";
+
+static fs::path hotmount_status_file() {
+    return fs::path(RUN_DIR) / HOTMOUNT_STATUS_FILE_NAME;
+}
+
+static uint64_t hotmount_now_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// One line, written to a temp file and renamed so the daemon never
+// reads a torn record (same dance as the binary state file)
+static void hotmount_report(const std::string& module_id, const char* phase, uint64_t done,
+                            uint64_t total) {
+    char line[512];
+    int n = snprintf(line, sizeof(line), "%s\t%s\t%llu\t%llu\t%llu\n", module_id.c_str(), phase,
+                     (unsigned long long)done, (unsigned long long)total,
+                     (unsigned long long)hotmount_now_ms());
+    if (n <= 0)
+        return;
+
+    std::string tmp_path = hotmount_status_file().string() + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return;
+    bool ok = write(fd, line, (size_t)n) == (ssize_t)n;
+    close(fd);
+    if (!ok || rename(tmp_path.c_str(), hotmount_status_file().c_str()) != 0)
+        unlink(tmp_path.c_str());
+}
+
+void hotmount_mark(const std::string& module_id, const std::string& phase) {
+    hotmount_report(module_id, phase.c_str(), 0, 0);
+}
+
+bool hot_mount_module(const Config& config, const std::string& module_id) {
+    fs::path module_path = config.moduledir / module_id;
+
+    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
+    all_partitions.insert(all_partitions.end(), config.partitions.begin(),
+                          config.partitions.end());
+    std::sort(all_partitions.begin(), all_partitions.end());
+    all_partitions.erase(std::unique(all_partitions.begin(), all_partitions.end()),
+                         all_partitions.end());
+
+    std::deque<std::vector<HymoBatchRule>> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_space;
+    std::condition_variable queue_data;
+    bool producer_done = false;
+
+    // discovered grows while the walk runs; done/total in the status
+    // file converge once the producer finishes
+    uint64_t discovered = 0;
+    uint64_t submitted = 0;
+    size_t partitions_found = 0;
+
+    hotmount_report(module_id, "walking", 0, 0);
+
+    auto push_chunk = [&](std::vector<HymoBatchRule>&& chunk) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_space.wait(lock, [&] { return queue.size() < HOTMOUNT_MAX_QUEUED; });
+        queue.push_back(std::move(chunk));
+        queue_data.notify_one();
+    };
+
+    std::thread producer([&] {
+        std::vector<HymoBatchRule> chunk;
+        chunk.reserve(HOTMOUNT_CHUNK);
+
+        for (const auto& part : all_partitions) {
+            fs::path src_dir = module_path / part;
+            if (!fs::is_directory(src_dir))
+                continue;
+            partitions_found++;
+
+            std::string target_root = "/" + part;
+            walk_directory(src_dir, "", [&](const WalkEntry& e) {
+                if (e.type == DT_REG || e.type == DT_LNK) {
+                    chunk.push_back({target_root + e.rel, e.path, 0, HYMO_BATCH_OP_ADD});
+                } else if (e.type == DT_CHR) {
+                    struct stat st;
+                    if (fstatat(e.parent_fd, e.name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                        st.st_rdev == 0) {
+                        chunk.push_back({target_root + e.rel, "", 0, HYMO_BATCH_OP_HIDE});
+                    }
+                }
+
+                if (chunk.size() >= HOTMOUNT_CHUNK) {
+                    __atomic_add_fetch(&discovered, chunk.size(), __ATOMIC_RELAXED);
+                    push_chunk(std::move(chunk));
+                    chunk = {};
+                    chunk.reserve(HOTMOUNT_CHUNK);
+                }
+                return WalkControl::Recurse;
+            });
+        }
+
+        if (!chunk.empty()) {
+            __atomic_add_fetch(&discovered, chunk.size(), __ATOMIC_RELAXED);
+            push_chunk(std::move(chunk));
+        }
+
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        producer_done = true;
+        queue_data.notify_one();
+    });
+
+    // Drain on the caller's thread: each chunk goes through the bulk
+    // ioctl while the producer keeps walking ahead
+    bool ok = true;
+    for (;;) {
+        std::vector<HymoBatchRule> chunk;
+        bool walking;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_data.wait(lock, [&] { return !queue.empty() || producer_done; });
+            if (queue.empty())
+                break;
+            chunk = std::move(queue.front());
+            queue.pop_front();
+            walking = !producer_done;
+            queue_space.notify_one();
+        }
+
+        if (!HymoFS::add_rules_batch(chunk))
+            ok = false;
+        submitted += chunk.size();
+        hotmount_report(module_id, walking ? "walking" : "submitting", submitted,
+                        __atomic_load_n(&discovered, __ATOMIC_RELAXED));
+    }
+    producer.join();
+
+    if (partitions_found == 0) {
+        hotmount_report(module_id, "done", 0, 0);
+        return false;
+    }
+
+    hotmount_report(module_id, ok ? "done" : "error", submitted, discovered);
+    LOG_INFO("Hot-mount pipeline for " + module_id + ": " + std::to_string(submitted) +
+             " rules across " + std::to_string(partitions_found) + " partitions");
+    return ok;
+}
+
+std::string export_hotmount_status_json() {
+    char module_buf[256] = "";
+    char phase_buf[32] = "idle";
+    unsigned long long done = 0, total = 0, updated_ms = 0;
+
+    FILE* f = fopen(hotmount_status_file().c_str(), "r");
+    if (f) {
+        if (fscanf(f, "%255[^\t]\t%31[^\t]\t%llu\t%llu\t%llu", module_buf, phase_buf, &done,
+                   &total, &updated_ms) != 5) {
+            strcpy(phase_buf, "idle");
+            module_buf[0] = '\0';
+            done = total = updated_ms = 0;
+        }
+        fclose(f);
+    }
+
+    json::Writer w(256);
+    w.begin_object();
+    w.key("module").value(module_buf);
+    w.key("phase").value(phase_buf);
+    w.key("done").value(done);
+    w.key("total").value(total);
+    w.key("updated_ms").value(updated_ms);
+    w.end_object();
+    return w.str();
+}
+
+}  // namespace hymo
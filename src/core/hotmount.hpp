@@ -0,0 +1,25 @@
+// core/hotmount.hpp - Pipelined hot-mount engine
+#pragma once
+
+#include <string>
+#include "../conf/config.hpp"
+
+namespace hymo {
+
+// Hot-mount one module's content: a producer thread walks the module
+// tree into a bounded chunk queue while the caller's thread drains it
+// through the bulk rule ioctl. Progress (rules submitted / discovered,
+// phase) is persisted after every chunk so the WebUI can poll it via
+// `api hotmount-status`. Returns false when no partition directory
+// exists or any chunk failed to submit.
+bool hot_mount_module(const Config& config, const std::string& module_id);
+
+// Coarse phase marker for operations without per-rule granularity
+// (hot-unmount): records module + phase with zero counts.
+void hotmount_mark(const std::string& module_id, const std::string& phase);
+
+// Latest progress record as JSON: module, phase, done, total,
+// updated_ms. phase is "idle" when no hot-mount has run.
+std::string export_hotmount_status_json();
+
+}  // namespace hymo
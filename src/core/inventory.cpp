@@ -35,6 +35,11 @@ static void parse_module_prop(const fs::path& module_path, Module& module) {
             module.description = value;
         else if (key == "mode")
             module.mode = value;
+        else if (key == "priority") {
+            for (char& c : value)
+                c = std::tolower(c);
+            module.deferred = (value == "deferred" || value == "low" || value == "background");
+        }
     }
 }
 
@@ -23,6 +23,9 @@ struct Module {
   std::string version = "";
   std::string author = "";
   std::string description = "";
+  // priority=deferred in module.prop moves the module out of the
+  // boot-critical mount phase; everything else mounts before do_mount returns
+  bool deferred = false;
   std::vector<ModuleRule> rules;
 };
 
@@ -1,10 +1,12 @@
 #pragma once
 #include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -275,5 +277,232 @@ inline Value parse(const std::string& s) {
     return Parser(s).parse();
 }
 
+// ---- Pull parser ----
+//
+// Non-owning tokenizer over the input buffer. Unlike the DOM parser
+// above it allocates nothing per node: string tokens are string_views
+// into the caller's buffer and escapes are only materialized when the
+// caller asks via unescape(). State and config files are read on every
+// CLI invocation, so their loaders use this instead of building a
+// Value tree; the DOM stays for the write side and for random access.
+
+enum class Event {
+    ObjectBegin,
+    ObjectEnd,
+    ArrayBegin,
+    ArrayEnd,
+    Key,
+    String,
+    Number,
+    Bool,
+    Null,
+    End,
+    Error
+};
+
+// Materialize a token's escaped content (the escapes Parser handles,
+// same lenient pass-through for anything else)
+inline std::string unescape(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        char c = s[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++i >= s.size())
+            break;
+        char next = s[i];
+        if (next == 'n')
+            out += '\n';
+        else if (next == 't')
+            out += '\t';
+        else if (next == '"')
+            out += '"';
+        else if (next == '\\')
+            out += '\\';
+        else
+            out += next;
+    }
+    return out;
+}
+
+class Reader {
+    std::string_view str;
+    size_t pos = 0;
+    std::string_view tok;
+    double num = 0;
+    bool b = false;
+    std::vector<char> stack;  // 'o' in object, 'a' in array
+    bool expect_key = false;
+    bool done = false;
+
+    void skip_whitespace() {
+        while (pos < str.size() && std::isspace((unsigned char)str[pos]))
+            pos++;
+    }
+
+    // Leaves `tok` as the raw (still escaped) slice between the quotes
+    bool scan_string() {
+        size_t start = ++pos;  // skip "
+        while (pos < str.size()) {
+            char c = str[pos];
+            if (c == '\\') {
+                pos += 2;
+                continue;
+            }
+            if (c == '"') {
+                tok = str.substr(start, pos - start);
+                pos++;
+                return true;
+            }
+            pos++;
+        }
+        return false;
+    }
+
+    // A value just finished at the current nesting level
+    Event after_value(Event e) {
+        if (stack.empty())
+            done = true;
+        else if (stack.back() == 'o')
+            expect_key = true;
+        return e;
+    }
+
+    Event close_frame(char kind, Event e) {
+        if (stack.empty() || stack.back() != kind)
+            return Event::Error;
+        stack.pop_back();
+        pos++;
+        return after_value(e);
+    }
+
+public:
+    explicit Reader(std::string_view input) : str(input) {}
+
+    // Raw slice of the last Key/String token (run through unescape()
+    // before storing it anywhere)
+    std::string_view token() const { return tok; }
+    double number() const { return num; }
+    bool boolean() const { return b; }
+
+    Event next() {
+        if (done)
+            return Event::End;
+        skip_whitespace();
+        if (pos >= str.size())
+            return stack.empty() ? Event::End : Event::Error;
+
+        char c = str[pos];
+        if (c == ',') {
+            pos++;
+            skip_whitespace();
+            if (pos >= str.size())
+                return Event::Error;
+            c = str[pos];
+        }
+
+        if (c == '}')
+            return close_frame('o', Event::ObjectEnd);
+        if (c == ']')
+            return close_frame('a', Event::ArrayEnd);
+
+        if (!stack.empty() && stack.back() == 'o' && expect_key) {
+            if (c != '"' || !scan_string())
+                return Event::Error;
+            skip_whitespace();
+            if (pos >= str.size() || str[pos] != ':')
+                return Event::Error;
+            pos++;
+            expect_key = false;
+            return Event::Key;
+        }
+
+        if (c == '{') {
+            stack.push_back('o');
+            expect_key = true;
+            pos++;
+            return Event::ObjectBegin;
+        }
+        if (c == '[') {
+            stack.push_back('a');
+            pos++;
+            return Event::ArrayBegin;
+        }
+        if (c == '"') {
+            if (!scan_string())
+                return Event::Error;
+            return after_value(Event::String);
+        }
+        if (c == 't') {
+            pos += 4;
+            b = true;
+            return after_value(Event::Bool);
+        }
+        if (c == 'f') {
+            pos += 5;
+            b = false;
+            return after_value(Event::Bool);
+        }
+        if (c == 'n') {
+            pos += 4;
+            return after_value(Event::Null);
+        }
+        if (c == '-' || std::isdigit((unsigned char)c)) {
+            char buf[64];
+            size_t len = 0;
+            while (pos < str.size() && len < sizeof(buf) - 1 &&
+                   (std::isdigit((unsigned char)str[pos]) || str[pos] == '-' || str[pos] == '+' ||
+                    str[pos] == '.' || str[pos] == 'e' || str[pos] == 'E')) {
+                buf[len++] = str[pos++];
+            }
+            buf[len] = '\0';
+            num = strtod(buf, nullptr);
+            return after_value(Event::Number);
+        }
+        return Event::Error;
+    }
+
+    // Consume the rest of a container whose Begin event was just returned
+    bool skip_container() {
+        int depth = 1;
+        while (depth > 0) {
+            switch (next()) {
+            case Event::ObjectBegin:
+            case Event::ArrayBegin:
+                depth++;
+                break;
+            case Event::ObjectEnd:
+            case Event::ArrayEnd:
+                depth--;
+                break;
+            case Event::Error:
+            case Event::End:
+                return false;
+            default:
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Consume the value following a Key event, containers included;
+    // lets flat loaders ignore keys they do not recognize
+    bool skip_value() {
+        switch (next()) {
+        case Event::ObjectBegin:
+        case Event::ArrayBegin:
+            return skip_container();
+        case Event::Error:
+        case Event::End:
+            return false;
+        default:
+            return true;
+        }
+    }
+};
+
 }  // namespace json
 }  // namespace hymo
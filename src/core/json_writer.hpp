@@ -0,0 +1,232 @@
+// core/json_writer.hpp - Streaming JSON writer for API output
+//
+// The DOM in json.hpp is convenient for parsing but expensive for
+// serialization: dump() builds nested temporaries recursively. This
+// writer appends straight into one flat buffer that callers can reuse
+// across responses (reset() keeps the capacity), escapes strings in
+// bulk runs instead of per character, and can flush directly to a file
+// descriptor.
+#pragma once
+
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hymo {
+namespace json {
+
+class Writer {
+public:
+    // indent < 0 emits compact JSON; >= 0 pretty-prints with that many
+    // spaces per level (one key/element per line, like dump(v, indent))
+    explicit Writer(size_t reserve = 4096, int indent = -1) : indent_(indent) {
+        buf_.reserve(reserve);
+    }
+
+    // Drop the content, keep the allocation
+    void reset() {
+        buf_.clear();
+        stack_.clear();
+        pending_key_ = false;
+    }
+
+    Writer& begin_object() { return open('{', '}'); }
+    Writer& end_object() { return close('}'); }
+    Writer& begin_array() { return open('[', ']'); }
+    Writer& end_array() { return close(']'); }
+
+    Writer& key(std::string_view k) {
+        before_element();
+        escape_append(k);
+        buf_.push_back(':');
+        if (indent_ >= 0)
+            buf_.push_back(' ');
+        pending_key_ = true;
+        return *this;
+    }
+
+    Writer& value(std::string_view v) {
+        before_element();
+        escape_append(v);
+        return *this;
+    }
+    Writer& value(const char* v) { return value(std::string_view(v)); }
+    Writer& value(const std::string& v) { return value(std::string_view(v)); }
+
+    Writer& value(bool v) {
+        before_element();
+        buf_.append(v ? "true" : "false");
+        return *this;
+    }
+
+    Writer& value(int v) { return value((long long)v); }
+    Writer& value(unsigned int v) { return value((unsigned long long)v); }
+    Writer& value(long v) { return value((long long)v); }
+    Writer& value(unsigned long v) { return value((unsigned long long)v); }
+
+    Writer& value(long long v) {
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "%lld", v);
+        before_element();
+        buf_.append(tmp, (size_t)n);
+        return *this;
+    }
+
+    Writer& value(unsigned long long v) {
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "%llu", v);
+        before_element();
+        buf_.append(tmp, (size_t)n);
+        return *this;
+    }
+
+    // Matches dump(): shortest representation, no trailing zeros
+    Writer& value(double v) {
+        char tmp[32];
+        int n = snprintf(tmp, sizeof(tmp), "%.6f", v);
+        while (n > 1 && tmp[n - 1] == '0')
+            n--;
+        if (n > 1 && tmp[n - 1] == '.')
+            n--;
+        before_element();
+        buf_.append(tmp, (size_t)n);
+        return *this;
+    }
+
+    // Fixed decimal places, for fields whose format the WebUI relies on
+    Writer& value_fixed(double v, int precision) {
+        char tmp[48];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", precision, v);
+        before_element();
+        buf_.append(tmp, (size_t)n);
+        return *this;
+    }
+
+    Writer& null_value() {
+        before_element();
+        buf_.append("null");
+        return *this;
+    }
+
+    // Embed pre-rendered JSON verbatim (e.g. a nested export)
+    Writer& value_raw(std::string_view rendered) {
+        before_element();
+        buf_.append(rendered);
+        return *this;
+    }
+
+    const std::string& str() const { return buf_; }
+
+    // Write the buffer straight to a file descriptor
+    bool flush(int fd) const {
+        size_t off = 0;
+        while (off < buf_.size()) {
+            ssize_t n = ::write(fd, buf_.data() + off, buf_.size() - off);
+            if (n <= 0)
+                return false;
+            off += (size_t)n;
+        }
+        return true;
+    }
+
+private:
+    struct Frame {
+        char closer;
+        bool first;
+    };
+
+    Writer& open(char opener, char closer) {
+        before_element();
+        buf_.push_back(opener);
+        stack_.push_back({closer, true});
+        return *this;
+    }
+
+    Writer& close(char closer) {
+        if (!stack_.empty()) {
+            bool had_elements = !stack_.back().first;
+            stack_.pop_back();
+            if (indent_ >= 0 && had_elements)
+                newline_indent(stack_.size());
+        }
+        buf_.push_back(closer);
+        return *this;
+    }
+
+    // Separator handling before any key, value or container
+    void before_element() {
+        if (pending_key_) {
+            pending_key_ = false;
+            return;
+        }
+        if (stack_.empty())
+            return;
+        if (!stack_.back().first)
+            buf_.push_back(',');
+        stack_.back().first = false;
+        if (indent_ >= 0)
+            newline_indent(stack_.size());
+    }
+
+    void newline_indent(size_t depth) {
+        buf_.push_back('\n');
+        buf_.append(depth * (size_t)indent_, ' ');
+    }
+
+    // Copy clean runs in one append; the scan is a flat byte
+    // classification the compiler can vectorize
+    void escape_append(std::string_view s) {
+        buf_.push_back('"');
+        size_t start = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            buf_.append(s.data() + start, i - start);
+            start = i + 1;
+            switch (c) {
+            case '"':
+                buf_.append("\\\"");
+                break;
+            case '\\':
+                buf_.append("\\\\");
+                break;
+            case '\b':
+                buf_.append("\\b");
+                break;
+            case '\f':
+                buf_.append("\\f");
+                break;
+            case '\n':
+                buf_.append("\\n");
+                break;
+            case '\r':
+                buf_.append("\\r");
+                break;
+            case '\t':
+                buf_.append("\\t");
+                break;
+            default: {
+                char tmp[8];
+                snprintf(tmp, sizeof(tmp), "\\u%04x", (int)c);
+                buf_.append(tmp, 6);
+                break;
+            }
+            }
+        }
+        buf_.append(s.data() + start, s.size() - start);
+        buf_.push_back('"');
+    }
+
+    std::string buf_;
+    std::vector<Frame> stack_;
+    int indent_;
+    bool pending_key_ = false;
+};
+
+}  // namespace json
+}  // namespace hymo
@@ -0,0 +1,198 @@
+// core/live_stats.cpp - Shared live metrics region implementation
+#include "live_stats.hpp"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include "../defs.hpp"
+#include "../utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+static const char* LIVE_STATS_FILE_NAME = "live_stats.bin";
+
+static constexpr uint32_t LIVE_STATS_MAGIC = 0x534C5948;  // "HYLS"
+static constexpr uint32_t LIVE_STATS_VERSION = 1;
+
+// On-disk/mmap layout. Guarded by a seqlock: `seq` is odd while a writer
+// is mid-update; readers retry until they see a stable even value.
+struct LiveStatsRegion {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t reserved;
+    uint64_t updated_ms;
+    uint64_t synced_bytes;
+    uint32_t module_count;
+    uint32_t reserved2;
+    uint64_t statfs_total;
+    uint64_t statfs_free;
+    uint64_t statfs_ms;
+};
+
+static uint64_t realtime_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Map the region once per process; `create` is the writer side
+static LiveStatsRegion* map_region(bool create) {
+    static LiveStatsRegion* mapped = nullptr;
+    static bool attempted = false;
+
+    if (mapped)
+        return mapped;
+    if (attempted && !create)
+        return nullptr;
+    attempted = true;
+
+    fs::path file = fs::path(RUN_DIR) / LIVE_STATS_FILE_NAME;
+
+    int flags = create ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDWR | O_CLOEXEC;
+    if (create) {
+        std::error_code ec;
+        fs::create_directories(RUN_DIR, ec);
+    }
+
+    int fd = open(file.c_str(), flags, 0600);
+    if (fd < 0)
+        return nullptr;
+
+    bool fresh = false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LiveStatsRegion)) {
+        if (!create || ftruncate(fd, sizeof(LiveStatsRegion)) != 0) {
+            close(fd);
+            return nullptr;
+        }
+        fresh = true;
+    }
+
+    void* mem =
+        mmap(nullptr, sizeof(LiveStatsRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+        return nullptr;
+
+    LiveStatsRegion* region = (LiveStatsRegion*)mem;
+    if (fresh || region->magic != LIVE_STATS_MAGIC || region->version != LIVE_STATS_VERSION) {
+        if (!create) {
+            munmap(mem, sizeof(LiveStatsRegion));
+            return nullptr;
+        }
+        memset(region, 0, sizeof(*region));
+        region->magic = LIVE_STATS_MAGIC;
+        region->version = LIVE_STATS_VERSION;
+    }
+
+    mapped = region;
+    return mapped;
+}
+
+bool live_stats_read(LiveStatsSnapshot& out) {
+    LiveStatsRegion* region = map_region(false);
+    if (!region)
+        return false;
+
+    for (int attempt = 0; attempt < 16; attempt++) {
+        uint32_t before = __atomic_load_n(&region->seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+            continue;  // writer mid-update
+
+        out.updated_ms = region->updated_ms;
+        out.synced_bytes = region->synced_bytes;
+        out.module_count = region->module_count;
+        out.statfs_total = region->statfs_total;
+        out.statfs_free = region->statfs_free;
+        out.statfs_ms = region->statfs_ms;
+
+        // The fence keeps the plain field loads above from sinking past
+        // the re-read; an acquire load alone would not order them
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t after = __atomic_load_n(&region->seq, __ATOMIC_RELAXED);
+        if (before == after)
+            return true;
+    }
+    return false;  // writer livelock; callers fall back to a direct probe
+}
+
+// Writer-side file lock, kept open for the process lifetime. The sync
+// totals come from the mount process while statfs refreshes come from
+// the daemon or CLI, so writers live in different processes and the
+// seqlock alone (single-writer by contract) is not enough: a second
+// writer could flip seq even while the first is mid-update. flock is
+// the exclusion that survives a crashed holder — the kernel drops it
+// with the process.
+static int writer_lock_fd() {
+    static int lock_fd = -1;
+    if (lock_fd < 0) {
+        fs::path file = fs::path(RUN_DIR) / LIVE_STATS_FILE_NAME;
+        lock_fd = open(file.c_str(), O_RDWR | O_CLOEXEC);
+    }
+    return lock_fd;
+}
+
+// Run fn between the seqlock edges
+template <typename Fn>
+static void write_region(Fn fn) {
+    LiveStatsRegion* region = map_region(true);
+    if (!region) {
+        LOG_DEBUG("Live stats region unavailable");
+        return;
+    }
+
+    // In-process exclusion first (flock is per open file description,
+    // not per thread), then the cross-process lock
+    static std::mutex local_mutex;
+    std::lock_guard<std::mutex> local(local_mutex);
+    int lock_fd = writer_lock_fd();
+    if (lock_fd >= 0) {
+        flock(lock_fd, LOCK_EX);
+    }
+
+    uint32_t seq = __atomic_load_n(&region->seq, __ATOMIC_RELAXED);
+    if (seq & 1) {
+        // A previous writer died mid-update; we hold the lock, so no
+        // writer is live and the odd count can be retired
+        seq++;
+    }
+    // Full fence: a release store only orders what comes before it, so
+    // without the fence fn's plain stores could be hoisted above the odd
+    // seq on weakly-ordered cores and readers would see data mutate while
+    // seq still reads as even
+    __atomic_store_n(&region->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    fn(region);
+    // The release store publishes fn's writes before seq turns even again
+    __atomic_store_n(&region->seq, seq + 2, __ATOMIC_RELEASE);
+
+    if (lock_fd >= 0) {
+        flock(lock_fd, LOCK_UN);
+    }
+}
+
+void live_stats_update_sync(uint64_t synced_bytes, uint32_t module_count) {
+    write_region([&](LiveStatsRegion* region) {
+        region->updated_ms = realtime_ms();
+        region->synced_bytes = synced_bytes;
+        region->module_count = module_count;
+    });
+}
+
+void live_stats_update_statfs(uint64_t total_bytes, uint64_t free_bytes) {
+    write_region([&](LiveStatsRegion* region) {
+        region->statfs_total = total_bytes;
+        region->statfs_free = free_bytes;
+        region->statfs_ms = realtime_ms();
+    });
+}
+
+}  // namespace hymo
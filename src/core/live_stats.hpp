@@ -0,0 +1,26 @@
+// core/live_stats.hpp - Shared live metrics region
+#pragma once
+
+#include <cstdint>
+
+namespace hymo {
+
+// One consistent read of the mmap'd metrics region. The mount/sync path
+// maintains the logical sizes; statfs fields are refreshed lazily by
+// whoever answers a storage query. Readers never walk the modules tree.
+struct LiveStatsSnapshot {
+    uint64_t updated_ms = 0;    // last sync-side update (CLOCK_REALTIME ms)
+    uint64_t synced_bytes = 0;  // logical size of all synced module content
+    uint32_t module_count = 0;  // modules with content at last sync
+    uint64_t statfs_total = 0;  // storage mount capacity at last refresh
+    uint64_t statfs_free = 0;
+    uint64_t statfs_ms = 0;  // when the statfs fields were refreshed
+};
+
+// False when the region does not exist yet (no sync has run)
+bool live_stats_read(LiveStatsSnapshot& out);
+
+void live_stats_update_sync(uint64_t synced_bytes, uint32_t module_count);
+void live_stats_update_statfs(uint64_t total_bytes, uint64_t free_bytes);
+
+}  // namespace hymo
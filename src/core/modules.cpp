@@ -7,21 +7,11 @@
 #include "../mount/hymofs.hpp"
 #include "../utils.hpp"
 #include "inventory.hpp"
-#include "json.hpp"  // Changed include
+#include "json_writer.hpp"
+#include "sync.hpp"
 
 namespace hymo {
 
-static bool has_content(const fs::path& module_path,
-                        const std::vector<std::string>& all_partitions) {
-    for (const auto& partition : all_partitions) {
-        fs::path part_path = module_path / partition;
-        if (has_files_recursive(part_path)) {
-            return true;
-        }
-    }
-    return false;
-}
-
 void update_module_description(bool success, const std::string& storage_mode, bool nuke_active,
                                size_t overlay_count, size_t magic_count, size_t hymofs_count,
                                const std::string& warning_msg, bool hymofs_active) {
@@ -81,7 +71,7 @@ void update_module_description(bool success, const std::string& storage_mode, bo
     LOG_DEBUG("Updated module description and name");
 }
 
-void print_module_list(const Config& config) {
+std::string export_module_list_json(const Config& config) {
     auto modules = scan_modules(config.moduledir, config);
 
     // Build complete partition list (builtin + extra)
@@ -93,16 +83,18 @@ void print_module_list(const Config& config) {
     // Filter modules with actual content (including extra partitions)
     std::vector<Module> filtered_modules;
     for (const auto& module : modules) {
-        if (has_content(module.source_path, all_partitions)) {
+        if (module_has_content(module.source_path, all_partitions)) {
             filtered_modules.push_back(module);
         }
     }
 
-    json::Value root = json::Value::object();
-    root["count"] = json::Value((int)filtered_modules.size());
-
-    json::Value mods_arr = json::Value::array();
+    // Streamed into one buffer; with 100+ modules the DOM version built
+    // thousands of temporaries just for response assembly
+    json::Writer w(16384, 2);
+    w.begin_object();
+    w.key("count").value((int)filtered_modules.size());
 
+    w.key("modules").begin_array();
     for (const auto& mod : filtered_modules) {
         std::string strategy = mod.mode;
         if (strategy == "auto") {
@@ -112,30 +104,34 @@ void print_module_list(const Config& config) {
                 strategy = "overlay";
         }
 
-        json::Value m = json::Value::object();
-        m["id"] = json::Value(mod.id);
-        m["path"] = json::Value(mod.source_path.string());
-        m["mode"] = json::Value(mod.mode);
-        m["strategy"] = json::Value(strategy);
-        m["name"] = json::Value(mod.name);
-        m["version"] = json::Value(mod.version);
-        m["author"] = json::Value(mod.author);
-        m["description"] = json::Value(mod.description);
-
-        json::Value rules_arr = json::Value::array();
+        w.begin_object();
+        w.key("id").value(mod.id);
+        w.key("path").value(mod.source_path.string());
+        w.key("mode").value(mod.mode);
+        w.key("strategy").value(strategy);
+        w.key("name").value(mod.name);
+        w.key("version").value(mod.version);
+        w.key("author").value(mod.author);
+        w.key("description").value(mod.description);
+
+        w.key("rules").begin_array();
         for (const auto& r : mod.rules) {
-            json::Value robj = json::Value::object();
-            robj["path"] = json::Value(r.path);
-            robj["mode"] = json::Value(r.mode);
-            rules_arr.push_back(robj);
+            w.begin_object();
+            w.key("path").value(r.path);
+            w.key("mode").value(r.mode);
+            w.end_object();
         }
-        m["rules"] = rules_arr;
-
-        mods_arr.push_back(m);
+        w.end_array();
+        w.end_object();
     }
+    w.end_array();
+    w.end_object();
 
-    root["modules"] = mods_arr;
-    std::cout << json::dump(root, 2) << "\n";
+    return w.str();
+}
+
+void print_module_list(const Config& config) {
+    std::cout << export_module_list_json(config) << "\n";
 }
 
 }  // namespace hymo
@@ -12,6 +12,9 @@ void update_module_description(bool success, const std::string &storage_mode,
                                const std::string &warning_msg = "",
                                bool hymofs_active = false);
 
+// Module inventory as a JSON document (shared by CLI and daemon)
+std::string export_module_list_json(const Config &config);
+
 void print_module_list(const Config &config);
 
 } // namespace hymo
@@ -0,0 +1,202 @@
+// core/path_index.cpp - Inverted module path index implementation
+#include "path_index.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "../defs.hpp"
+#include "../utils.hpp"
+#include "json_writer.hpp"
+#include "plan_cache.hpp"
+#include "state.hpp"
+#include "sync.hpp"
+
+namespace hymo {
+
+static const char* PATH_INDEX_FILE_NAME = "path_index.tsv";
+
+static fs::path path_index_file() {
+    return fs::path(RUN_DIR) / PATH_INDEX_FILE_NAME;
+}
+
+uint64_t compute_path_index_digest(const std::vector<Module>& modules) {
+    // Hash in sorted order so the digest only depends on the module set,
+    // not on directory iteration order
+    std::map<std::string, const Module*> by_id;
+    for (const auto& module : modules) {
+        by_id[module.id] = &module;
+    }
+
+    Fnv1a h;
+    for (const auto& [id, module] : by_id) {
+        h.update(id);
+        struct stat st;
+        fs::path prop = module->source_path / "module.prop";
+        if (stat(prop.c_str(), &st) == 0) {
+            h.update((uint64_t)st.st_size);
+            h.update((uint64_t)st.st_mtim.tv_sec);
+            h.update((uint64_t)st.st_mtim.tv_nsec);
+        }
+    }
+    return h.hash;
+}
+
+bool load_path_index(PathIndex& out) {
+    std::ifstream in(path_index_file());
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    if (!std::getline(in, line) || sscanf(line.c_str(), "digest %llx",
+                                          (unsigned long long*)&out.digest) != 1) {
+        return false;
+    }
+
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+            continue;
+        std::vector<std::string>& ids = out.providers[line.substr(0, tab)];
+        size_t pos = tab + 1;
+        while (pos < line.size()) {
+            size_t next = line.find('\t', pos);
+            if (next == std::string::npos)
+                next = line.size();
+            ids.push_back(line.substr(pos, next - pos));
+            pos = next + 1;
+        }
+    }
+    return true;
+}
+
+bool save_path_index(const PathIndex& index) {
+    std::error_code ec;
+    fs::create_directories(RUN_DIR, ec);
+
+    std::ofstream out(path_index_file(), std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "digest %llx\n", (unsigned long long)index.digest);
+    out << buf;
+    for (const auto& [path, ids] : index.providers) {
+        out << path;
+        for (const auto& id : ids) {
+            out << '\t' << id;
+        }
+        out << '\n';
+    }
+    return out.good();
+}
+
+// Index one module by walking its live tree; used when no sync manifest
+// exists (CLI runs before any boot, or non-synced storage)
+static void index_module_by_walk(const Module& module,
+                                 const std::vector<std::string>& all_partitions,
+                                 PathIndex& index) {
+    for (const auto& part : all_partitions) {
+        fs::path part_dir = module.source_path / part;
+        if (!fs::exists(part_dir) || !fs::is_directory(part_dir))
+            continue;
+
+        try {
+            for (auto it = fs::recursive_directory_iterator(part_dir);
+                 it != fs::recursive_directory_iterator(); ++it) {
+                if (fs::is_regular_file(it->status()) || fs::is_symlink(it->status())) {
+                    fs::path rel = fs::relative(it->path(), part_dir);
+                    index.providers["/" + part + "/" + rel.string()].push_back(module.id);
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            continue;  // skip inaccessible directories
+        }
+    }
+}
+
+PathIndex build_path_index(const Config& config, const std::vector<Module>& modules,
+                           const fs::path& storage_root) {
+    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
+    all_partitions.insert(all_partitions.end(), config.partitions.begin(),
+                          config.partitions.end());
+    std::set<std::string> partition_set(all_partitions.begin(), all_partitions.end());
+
+    PathIndex index;
+    for (const auto& module : modules) {
+        if (fs::exists(module.source_path / DISABLE_FILE_NAME))
+            continue;
+
+        bool indexed =
+            !storage_root.empty() &&
+            for_each_manifest_path(storage_root / module.id,
+                                   [&](const std::string& rel, char type) {
+                                       if (type != 'f' && type != 'l')
+                                           return;
+                                       size_t slash = rel.find('/');
+                                       if (slash == std::string::npos ||
+                                           partition_set.find(rel.substr(0, slash)) ==
+                                               partition_set.end())
+                                           return;
+                                       index.providers["/" + rel].push_back(module.id);
+                                   });
+
+        if (!indexed) {
+            index_module_by_walk(module, all_partitions, index);
+        }
+    }
+    return index;
+}
+
+void update_path_index(const Config& config, const std::vector<Module>& modules,
+                       const fs::path& storage_root) {
+    PathIndex index = build_path_index(config, modules, storage_root);
+    index.digest = compute_path_index_digest(modules);
+    if (!save_path_index(index)) {
+        LOG_WARN("Failed to persist path index");
+    }
+}
+
+std::string export_conflicts_json(const Config& config) {
+    auto modules = scan_modules(config.moduledir, config);
+    uint64_t digest = compute_path_index_digest(modules);
+
+    PathIndex index;
+    if (!load_path_index(index) || index.digest != digest) {
+        // Stale or missing: rebuild against the current storage (the
+        // manifests there are single-file reads) and persist for next time
+        RuntimeState state = load_runtime_state();
+        index = build_path_index(config, modules, fs::path(state.mount_point));
+        index.digest = digest;
+        save_path_index(index);
+    }
+
+    json::Writer w(4096);
+    w.begin_array();
+    for (const auto& [file_path, module_ids] : index.providers) {
+        if (module_ids.size() <= 1)
+            continue;
+
+        w.begin_object();
+        w.key("file").value(file_path);
+        w.key("modules").begin_array();
+        for (const auto& id : module_ids)
+            w.value(id);
+        w.end_array();
+
+        std::string message = "File '" + file_path + "' is modified by " +
+                              std::to_string(module_ids.size()) + " modules: ";
+        for (size_t i = 0; i < module_ids.size(); ++i) {
+            if (i > 0)
+                message += ", ";
+            message += module_ids[i];
+        }
+        w.key("message").value(message);
+        w.end_object();
+    }
+    w.end_array();
+    return w.str();
+}
+
+}  // namespace hymo
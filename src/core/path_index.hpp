@@ -0,0 +1,46 @@
+// core/path_index.hpp - Inverted module path index
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "../conf/config.hpp"
+#include "inventory.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+// Inverted index over module content: virtual path -> providing module
+// ids. Built from the sync manifests (or a tree walk when no synced
+// storage exists) and persisted, so conflict detection is one index
+// scan instead of re-walking every module tree.
+struct PathIndex {
+    uint64_t digest = 0;  // identity of the module set it was built from
+    std::map<std::string, std::vector<std::string>> providers;
+};
+
+// Cheap identity of the module set: sorted ids plus module.prop
+// signatures. Same trust model as the sync up-to-date check.
+uint64_t compute_path_index_digest(const std::vector<Module>& modules);
+
+bool load_path_index(PathIndex& out);
+bool save_path_index(const PathIndex& index);
+
+// Build from the sync manifests under storage_root where present,
+// walking the live module tree otherwise
+PathIndex build_path_index(const Config& config, const std::vector<Module>& modules,
+                           const fs::path& storage_root);
+
+// Refresh the persisted index; called after a sync while the manifests
+// are warm
+void update_path_index(const Config& config, const std::vector<Module>& modules,
+                       const fs::path& storage_root);
+
+// Paths provided by more than one module, as a JSON array (shared by
+// `module check-conflicts`, `api conflicts` and the daemon)
+std::string export_conflicts_json(const Config& config);
+
+}  // namespace hymo
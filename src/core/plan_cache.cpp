@@ -0,0 +1,263 @@
+// core/plan_cache.cpp - Persistent boot plan cache implementation
+#include "plan_cache.hpp"
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "../mount/hymofs.hpp"
+#include "../utils.hpp"
+
+namespace hymo {
+
+static constexpr uint32_t PLAN_CACHE_MAGIC = 0x43505948;  // "HYPC"
+static constexpr uint32_t PLAN_CACHE_VERSION = 1;
+
+// ---- Digest (FNV-1a 64, hasher shared via plan_cache.hpp) ----
+
+static void digest_file_content(Fnv1a& h, const fs::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open())
+        return;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    h.update(buffer.str());
+}
+
+// Fold the lstat signature of every entry under dir into the digest.
+// Cheap compared to plan generation: no rule matching, no context lookups.
+static void digest_tree(Fnv1a& h, const fs::path& dir, const std::string& rel_prefix) {
+    try {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            std::string rel = rel_prefix + "/" + entry.path().filename().string();
+
+            struct stat st;
+            if (lstat(entry.path().c_str(), &st) != 0)
+                continue;
+
+            h.update(rel);
+            h.update((uint64_t)st.st_mode);
+            h.update((uint64_t)st.st_size);
+            h.update((uint64_t)st.st_mtim.tv_sec);
+            h.update((uint64_t)st.st_mtim.tv_nsec);
+
+            if (S_ISDIR(st.st_mode))
+                digest_tree(h, entry.path(), rel);
+        }
+    } catch (...) {
+    }
+}
+
+uint64_t compute_plan_digest(const Config& config, const std::vector<Module>& modules,
+                             const fs::path& storage_root) {
+    Fnv1a h;
+
+    h.update(storage_root.string());
+    for (const auto& part : config.partitions) {
+        h.update(part);
+    }
+
+    // Plan mode classification depends on HymoFS availability
+    h.update((uint64_t)HymoFS::check_status());
+    h.update((uint64_t)config.ignore_protocol_mismatch);
+    h.update((uint64_t)config.hymofs_enabled);
+
+    for (const auto& module : modules) {
+        h.update(module.id);
+        h.update(module.mode);
+        for (const auto& rule : module.rules) {
+            h.update(rule.path);
+            h.update(rule.mode);
+        }
+        digest_file_content(h, module.source_path / "module.prop");
+        digest_file_content(h, module.source_path / "hymo_rules.conf");
+        digest_tree(h, module.source_path, "");
+    }
+
+    return h.hash;
+}
+
+// ---- Binary serialization ----
+
+static void write_u32(std::ofstream& out, uint32_t v) {
+    out.write((const char*)&v, sizeof(v));
+}
+
+static void write_u64(std::ofstream& out, uint64_t v) {
+    out.write((const char*)&v, sizeof(v));
+}
+
+static void write_str(std::ofstream& out, const std::string& s) {
+    write_u32(out, (uint32_t)s.size());
+    out.write(s.data(), s.size());
+}
+
+static void write_str_list(std::ofstream& out, const std::vector<std::string>& list) {
+    write_u32(out, (uint32_t)list.size());
+    for (const auto& s : list) {
+        write_str(out, s);
+    }
+}
+
+static bool read_u32(std::ifstream& in, uint32_t& v) {
+    in.read((char*)&v, sizeof(v));
+    return in.good();
+}
+
+static bool read_u64(std::ifstream& in, uint64_t& v) {
+    in.read((char*)&v, sizeof(v));
+    return in.good();
+}
+
+static bool read_str(std::ifstream& in, std::string& s) {
+    uint32_t len;
+    if (!read_u32(in, len) || len > (64u << 20))
+        return false;
+    s.resize(len);
+    in.read(&s[0], len);
+    return in.good();
+}
+
+static bool read_str_list(std::ifstream& in, std::vector<std::string>& list) {
+    uint32_t count;
+    if (!read_u32(in, count) || count > (16u << 20))
+        return false;
+    list.resize(count);
+    for (auto& s : list) {
+        if (!read_str(in, s))
+            return false;
+    }
+    return true;
+}
+
+bool save_plan_cache(const fs::path& cache_file, uint64_t digest, const MountPlan& plan,
+                     const HymoFSRuleSet& rule_set) {
+    fs::path tmp_file = cache_file;
+    tmp_file += ".tmp";
+
+    {
+        std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("Plan cache: cannot open " + tmp_file.string());
+            return false;
+        }
+
+        write_u32(out, PLAN_CACHE_MAGIC);
+        write_u32(out, PLAN_CACHE_VERSION);
+        write_u64(out, digest);
+
+        write_u32(out, (uint32_t)plan.overlay_ops.size());
+        for (const auto& op : plan.overlay_ops) {
+            write_str(out, op.target);
+            write_u32(out, (uint32_t)op.lowerdirs.size());
+            for (const auto& layer : op.lowerdirs) {
+                write_str(out, layer.string());
+            }
+        }
+
+        std::vector<std::string> magic_paths;
+        for (const auto& p : plan.magic_module_paths) {
+            magic_paths.push_back(p.string());
+        }
+        write_str_list(out, magic_paths);
+        write_str_list(out, plan.overlay_module_ids);
+        write_str_list(out, plan.magic_module_ids);
+        write_str_list(out, plan.hymofs_module_ids);
+
+        write_u32(out, (uint32_t)rule_set.size());
+        for (const auto& rule : rule_set) {
+            write_str(out, rule.src);
+            write_str(out, rule.target);
+            write_u32(out, (uint32_t)rule.type);
+            write_u32(out, (uint32_t)rule.op);
+            write_str(out, rule.module_id);
+        }
+
+        if (!out.good()) {
+            LOG_WARN("Plan cache: write failed");
+            return false;
+        }
+    }
+
+    // Rename is atomic: readers never see a half-written cache
+    std::error_code ec;
+    fs::rename(tmp_file, cache_file, ec);
+    if (ec) {
+        LOG_WARN("Plan cache: rename failed: " + ec.message());
+        return false;
+    }
+
+    LOG_INFO("Plan cache saved (" + std::to_string(rule_set.size()) + " rules)");
+    return true;
+}
+
+bool load_plan_cache(const fs::path& cache_file, uint64_t digest, MountPlan& plan,
+                     HymoFSRuleSet& rule_set) {
+    std::ifstream in(cache_file, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    uint32_t magic, version;
+    uint64_t stored_digest;
+    if (!read_u32(in, magic) || magic != PLAN_CACHE_MAGIC || !read_u32(in, version) ||
+        version != PLAN_CACHE_VERSION || !read_u64(in, stored_digest)) {
+        LOG_DEBUG("Plan cache: bad header, ignoring");
+        return false;
+    }
+
+    if (stored_digest != digest) {
+        LOG_INFO("Plan cache: digest mismatch, regenerating plan");
+        return false;
+    }
+
+    uint32_t op_count;
+    if (!read_u32(in, op_count) || op_count > (1u << 20))
+        return false;
+
+    MountPlan loaded;
+    loaded.overlay_ops.resize(op_count);
+    for (auto& op : loaded.overlay_ops) {
+        uint32_t layer_count;
+        if (!read_str(in, op.target) || !read_u32(in, layer_count) || layer_count > (1u << 20))
+            return false;
+        op.lowerdirs.resize(layer_count);
+        for (auto& layer : op.lowerdirs) {
+            std::string s;
+            if (!read_str(in, s))
+                return false;
+            layer = s;
+        }
+    }
+
+    std::vector<std::string> magic_paths;
+    if (!read_str_list(in, magic_paths) || !read_str_list(in, loaded.overlay_module_ids) ||
+        !read_str_list(in, loaded.magic_module_ids) ||
+        !read_str_list(in, loaded.hymofs_module_ids)) {
+        return false;
+    }
+    for (const auto& p : magic_paths) {
+        loaded.magic_module_paths.push_back(p);
+    }
+
+    uint32_t rule_count;
+    if (!read_u32(in, rule_count) || rule_count > (16u << 20))
+        return false;
+
+    HymoFSRuleSet loaded_rules;
+    loaded_rules.resize(rule_count);
+    for (auto& rule : loaded_rules) {
+        uint32_t type, op;
+        if (!read_str(in, rule.src) || !read_str(in, rule.target) || !read_u32(in, type) ||
+            !read_u32(in, op) || !read_str(in, rule.module_id)) {
+            return false;
+        }
+        rule.type = (int)type;
+        rule.op = (int)op;
+    }
+
+    plan = std::move(loaded);
+    rule_set = std::move(loaded_rules);
+    LOG_INFO("Plan cache hit (" + std::to_string(rule_set.size()) + " rules)");
+    return true;
+}
+
+}  // namespace hymo
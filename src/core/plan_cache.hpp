@@ -0,0 +1,46 @@
+// core/plan_cache.hpp - Persistent boot plan cache
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "../conf/config.hpp"
+#include "inventory.hpp"
+#include "planner.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+// Incremental FNV-1a 64 hasher, shared by the digest-keyed caches
+struct Fnv1a {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    void update(const void* data, size_t len) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < len; i++) {
+            hash ^= p[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    void update(const std::string& s) { update(s.data(), s.size()); }
+    void update(uint64_t v) { update(&v, sizeof(v)); }
+};
+
+// Digest over everything that feeds plan generation: module ids/modes/rules,
+// module.prop and hymo_rules.conf contents, source tree lstat signatures,
+// configured partitions and HymoFS availability. A cached plan is valid only
+// while this digest matches.
+uint64_t compute_plan_digest(const Config& config, const std::vector<Module>& modules,
+                             const fs::path& storage_root);
+
+// Load a cached plan + rule set; returns false on missing file, format
+// mismatch or digest mismatch.
+bool load_plan_cache(const fs::path& cache_file, uint64_t digest, MountPlan& plan,
+                     HymoFSRuleSet& rule_set);
+
+// Atomically persist the plan + rule set keyed by digest
+bool save_plan_cache(const fs::path& cache_file, uint64_t digest, const MountPlan& plan,
+                     const HymoFSRuleSet& rule_set);
+
+}  // namespace hymo
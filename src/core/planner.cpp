@@ -4,55 +4,145 @@
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include "../defs.hpp"
+#include "../dirwalk.hpp"
 #include "../mount/hymofs.hpp"
 #include "../utils.hpp"
+#include "plan_cache.hpp"
+#include "sync.hpp"
+#include "telemetry.hpp"
+#include "timings.hpp"
 #include "user_rules.hpp"
 
 namespace hymo {
 
-bool MountPlan::is_covered_by_overlay(const std::string& path) const {
-    for (const auto& op : overlay_ops) {
-        std::string p_str = path;
-        std::string t_str = op.target;
+void PathPrefixMatcher::insert(const std::string& path, int value) {
+    TrieNode* node = &root_;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        while (pos < path.size() && path[pos] == '/')
+            pos++;
+        if (pos >= path.size())
+            break;
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos)
+            end = path.size();
+        node = &node->children[path.substr(pos, end - pos)];
+        pos = end;
+    }
+    if (node->value < 0)
+        node->value = value;
+}
 
-        if (p_str == t_str)
-            return true;
+int PathPrefixMatcher::match(const std::string& path) const {
+    const TrieNode* node = &root_;
+    int best = -1;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        while (pos < path.size() && path[pos] == '/')
+            pos++;
+        if (pos >= path.size())
+            break;
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos)
+            end = path.size();
+        auto it = node->children.find(path.substr(pos, end - pos));
+        if (it == node->children.end())
+            break;
+        node = &it->second;
+        if (node->value >= 0)
+            best = node->value;
+        pos = end;
+    }
+    return best;
+}
 
-        if (p_str.size() > t_str.size() && p_str.compare(0, t_str.size(), t_str) == 0 &&
-            p_str[t_str.size()] == '/') {
-            return true;
-        }
+PathPrefixMatcher MountPlan::build_overlay_matcher() const {
+    PathPrefixMatcher matcher;
+    for (size_t i = 0; i < overlay_ops.size(); i++) {
+        matcher.insert(overlay_ops[i].target, (int)i);
     }
-    return false;
+    return matcher;
 }
 
-static bool has_files(const fs::path& path) {
-    if (!fs::exists(path) || !fs::is_directory(path)) {
-        return false;
+bool MountPlan::is_covered_by_overlay(const std::string& path) const {
+    return build_overlay_matcher().match(path) >= 0;
+}
+
+// Matcher over one module's rules; match() yields the rule index
+static PathPrefixMatcher build_rule_matcher(const Module& module) {
+    PathPrefixMatcher matcher;
+    for (size_t i = 0; i < module.rules.size(); i++) {
+        matcher.insert(module.rules[i].path, (int)i);
     }
-    try {
-        for (const auto& entry : fs::directory_iterator(path)) {
-            (void)entry;
+    return matcher;
+}
+
+bool ModuleScan::has_content() const {
+    for (const auto& [part, entries] : partitions) {
+        if (!entries.empty())
             return true;
-        }
-    } catch (...) {
-        return false;
     }
     return false;
 }
 
-static bool has_meaningful_content(const fs::path& base,
-                                   const std::vector<std::string>& partitions) {
-    for (const auto& part : partitions) {
-        fs::path p = base / part;
-        if (fs::exists(p) && has_files(p)) {
-            return true;
+// Depth-first scan collecting entry types and whiteout flags in one pass.
+// The shared getdents64 walker already resolves DT_UNKNOWN; only symlinks
+// and character devices need an extra stat here.
+static void scan_tree(const fs::path& dir, const std::string& rel_prefix,
+                      std::vector<ScanEntry>& out) {
+    walk_directory(dir, rel_prefix, [&](const WalkEntry& e) {
+        int stat_type = e.type;
+        bool whiteout = false;
+        if (e.type == DT_LNK) {
+            struct stat st;
+            if (fstatat(e.parent_fd, e.name, &st, 0) == 0)
+                stat_type = mode_to_dt(st.st_mode);
+        } else if (e.type == DT_CHR) {
+            struct stat st;
+            if (fstatat(e.parent_fd, e.name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                major(st.st_rdev) == 0 && minor(st.st_rdev) == 0) {
+                whiteout = true;
+            }
+        }
+
+        out.push_back({e.rel, e.path, e.type, stat_type, whiteout});
+        return WalkControl::Recurse;
+    });
+}
+
+ModuleScanIndex build_module_scan_index(const Config& config, const std::vector<Module>& modules,
+                                        const fs::path& storage_root) {
+    ModuleScanIndex index;
+
+    std::vector<std::string> target_partitions = BUILTIN_PARTITIONS;
+    for (const auto& part : config.partitions) {
+        target_partitions.push_back(part);
+    }
+
+    for (const auto& module : modules) {
+        fs::path content_path = storage_root / module.id;
+        if (!fs::exists(content_path))
+            continue;
+
+        ModuleScan scan;
+        for (const auto& part : target_partitions) {
+            fs::path part_root = content_path / part;
+            if (!fs::is_directory(part_root))
+                continue;
+            scan_tree(part_root, "/" + part, scan.partitions[part]);
         }
+        index.modules.emplace(module.id, std::move(scan));
     }
-    return false;
+    return index;
 }
 
 // Helper: Resolve symlinks in directory symlinks but preserve filename logic
@@ -91,8 +181,260 @@ static std::string resolve_path_for_hymofs(const std::string& path_str) {
     }
 }
 
+// ---- Overlay layer composition ----
+//
+// With many overlay modules on one partition the raw lowerdir stack
+// carries duplicates and layers whose every path is already provided by
+// a higher-priority layer; both inflate the kernel's lowerdir string and
+// slow overlay lookup. The pass below deduplicates, drops fully-shadowed
+// layers using the sync manifests, and caches the composed stack per
+// layer-set digest so unchanged compositions are reused across boots.
+
+static const char* LOWERDIR_CACHE_FILE_NAME = "lowerdir_cache.tsv";
+
+// Module storage dir a layer lives in, or empty when the layer is not
+// under the storage root. `prefix` receives the layer path relative to
+// the module dir ("system", or deeper for exact-rule layers).
+static fs::path layer_module_dir(const fs::path& layer, const fs::path& storage_root,
+                                 std::string& prefix) {
+    std::string root = storage_root.string();
+    while (!root.empty() && root.back() == '/')
+        root.pop_back();
+    const std::string& l = layer.native();
+    if (root.empty() || l.size() <= root.size() || l.compare(0, root.size(), root) != 0 ||
+        l[root.size()] != '/') {
+        return fs::path();
+    }
+
+    size_t id_start = root.size() + 1;
+    size_t slash = l.find('/', id_start);
+    if (slash == std::string::npos || slash + 1 >= l.size()) {
+        return fs::path();
+    }
+    prefix = l.substr(slash + 1);
+    return fs::path(l.substr(0, slash));
+}
+
+// Paths the layer provides, relative to the layer root, straight from
+// the sync manifest; false when the layer has no manifest coverage.
+// Only non-directory entries land in `cover`: overlayfs merges
+// directories, so a dir in a higher layer shadows nothing below it.
+// `need` holds everything that must be covered before the layer may go.
+// Layers carrying negative entries — whiteout device nodes or .replace
+// markers — clear `droppable`, since removing them would reveal exactly
+// the lower-layer content they suppress. (Opaque dirs marked only by
+// xattr are invisible to the manifest, but a layer is dropped only when
+// every path in it sits under a higher non-directory entry, which hides
+// the dir and its opacity wholesale.)
+static bool collect_layer_paths(const fs::path& layer, const fs::path& storage_root,
+                                std::unordered_set<std::string>& cover,
+                                std::unordered_set<std::string>& need, bool& droppable) {
+    std::string prefix;
+    fs::path module_dir = layer_module_dir(layer, storage_root, prefix);
+    if (module_dir.empty()) {
+        return false;
+    }
+
+    const std::string replace_name = REPLACE_DIR_FILE_NAME;
+    return for_each_manifest_path(module_dir, [&](const std::string& rel, char type) {
+        if (rel.size() <= prefix.size() || rel.compare(0, prefix.size(), prefix) != 0 ||
+            rel[prefix.size()] != '/') {
+            return;
+        }
+        std::string sub = rel.substr(prefix.size() + 1);
+
+        if (type == 'c' || type == 'b') {
+            droppable = false;
+        }
+        if (sub.size() >= replace_name.size() &&
+            sub.compare(sub.size() - replace_name.size(), replace_name.size(), replace_name) ==
+                0 &&
+            (sub.size() == replace_name.size() ||
+             sub[sub.size() - replace_name.size() - 1] == '/')) {
+            droppable = false;
+        }
+
+        if (type != 'd') {
+            cover.insert(sub);
+        }
+        need.insert(std::move(sub));
+    });
+}
+
+// Digest of one op's input stack: target, ordered layer paths, and the
+// size/mtime signature of each backing manifest, so content changes
+// invalidate the cached composition
+static uint64_t compose_digest(const OverlayOperation& op, const fs::path& storage_root) {
+    Fnv1a h;
+    // Bumped whenever the shadow rules change so stale cached stacks
+    // computed under the old rules are never replayed
+    h.update("compose-v2");
+    h.update(op.target);
+    for (const auto& layer : op.lowerdirs) {
+        h.update(layer.string());
+
+        std::string prefix;
+        fs::path module_dir = layer_module_dir(layer, storage_root, prefix);
+        if (module_dir.empty()) {
+            continue;
+        }
+        struct stat st;
+        if (stat(sync_manifest_path(module_dir).c_str(), &st) == 0) {
+            h.update((uint64_t)st.st_size);
+            h.update((uint64_t)st.st_mtim.tv_sec);
+            h.update((uint64_t)st.st_mtim.tv_nsec);
+        }
+    }
+    return h.hash;
+}
+
+static fs::path lowerdir_cache_file() {
+    return fs::path(RUN_DIR) / LOWERDIR_CACHE_FILE_NAME;
+}
+
+// One line per composition: "digest<TAB>layer<TAB>layer..."
+static void load_lowerdir_cache(std::unordered_map<uint64_t, std::vector<fs::path>>& out) {
+    std::ifstream in(lowerdir_cache_file());
+    if (!in.is_open())
+        return;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        unsigned long long digest;
+        if (tab == std::string::npos ||
+            sscanf(line.substr(0, tab).c_str(), "%llx", &digest) != 1) {
+            continue;
+        }
+
+        std::vector<fs::path>& layers = out[digest];
+        size_t pos = tab + 1;
+        while (pos < line.size()) {
+            size_t next = line.find('\t', pos);
+            if (next == std::string::npos)
+                next = line.size();
+            layers.emplace_back(line.substr(pos, next - pos));
+            pos = next + 1;
+        }
+    }
+}
+
+static void save_lowerdir_cache(
+    const std::unordered_map<uint64_t, std::vector<fs::path>>& cache) {
+    std::error_code ec;
+    fs::create_directories(RUN_DIR, ec);
+
+    std::ofstream out(lowerdir_cache_file(), std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_WARN("Failed to persist lowerdir composition cache");
+        return;
+    }
+
+    char buf[24];
+    for (const auto& [digest, layers] : cache) {
+        snprintf(buf, sizeof(buf), "%llx", (unsigned long long)digest);
+        out << buf;
+        for (const auto& layer : layers) {
+            out << '\t' << layer.string();
+        }
+        out << '\n';
+    }
+}
+
+static void compose_overlay_layers(MountPlan& plan, const fs::path& storage_root) {
+    if (plan.overlay_ops.empty())
+        return;
+
+    std::unordered_map<uint64_t, std::vector<fs::path>> cache;
+    load_lowerdir_cache(cache);
+
+    // Rewritten with only this boot's compositions, so stale layer sets
+    // do not accumulate
+    std::unordered_map<uint64_t, std::vector<fs::path>> used;
+    bool changed = false;
+
+    for (auto& op : plan.overlay_ops) {
+        // Deduplicate, keeping the first (highest-priority) occurrence
+        std::unordered_set<std::string> seen;
+        std::vector<fs::path> unique_layers;
+        unique_layers.reserve(op.lowerdirs.size());
+        for (auto& layer : op.lowerdirs) {
+            if (seen.insert(layer.native()).second) {
+                unique_layers.push_back(std::move(layer));
+            }
+        }
+        if (unique_layers.size() != op.lowerdirs.size()) {
+            LOG_DEBUG("Dropped " + std::to_string(op.lowerdirs.size() - unique_layers.size()) +
+                      " duplicate overlay layers for " + op.target);
+        }
+        op.lowerdirs = std::move(unique_layers);
+        if (op.lowerdirs.size() <= 1) {
+            continue;
+        }
+
+        uint64_t digest = compose_digest(op, storage_root);
+        auto it = cache.find(digest);
+        if (it != cache.end()) {
+            op.lowerdirs = it->second;
+            used.emplace(digest, std::move(it->second));
+            continue;
+        }
+
+        // Shadow pass: a layer whose every manifest path is already
+        // provided by higher-priority non-directory entries is invisible
+        // to lookup. Layers without manifest coverage are kept and
+        // contribute no coverage, so dropping always has proof behind it,
+        // and layers holding whiteouts or .replace markers are never
+        // dropped — they exist to suppress lower content.
+        std::unordered_set<std::string> covered;
+        std::vector<fs::path> kept;
+        kept.reserve(op.lowerdirs.size());
+        for (const auto& layer : op.lowerdirs) {
+            std::unordered_set<std::string> cover;
+            std::unordered_set<std::string> need;
+            bool droppable = true;
+            if (!collect_layer_paths(layer, storage_root, cover, need, droppable) ||
+                need.empty()) {
+                kept.push_back(layer);
+                continue;
+            }
+
+            bool shadowed = droppable;
+            if (shadowed) {
+                for (const auto& p : need) {
+                    if (covered.find(p) == covered.end()) {
+                        shadowed = false;
+                        break;
+                    }
+                }
+            }
+            if (shadowed) {
+                LOG_DEBUG("Overlay layer fully shadowed, dropping: " + layer.string());
+                continue;
+            }
+
+            covered.insert(cover.begin(), cover.end());
+            kept.push_back(layer);
+        }
+
+        if (kept.size() != op.lowerdirs.size()) {
+            LOG_INFO("Overlay composition for " + op.target + ": " +
+                     std::to_string(op.lowerdirs.size() - kept.size()) +
+                     " shadowed layers dropped (" + std::to_string(kept.size()) + " remain)");
+        }
+        op.lowerdirs = kept;
+        used.emplace(digest, std::move(kept));
+        changed = true;
+    }
+
+    if (changed || used.size() != cache.size()) {
+        save_lowerdir_cache(used);
+    }
+}
+
 MountPlan generate_plan(const Config& config, const std::vector<Module>& modules,
-                        const fs::path& storage_root) {
+                        const fs::path& storage_root, const ModuleScanIndex& scan_index) {
+    ScopedTimer timer("generate_plan");
     MountPlan plan;
 
     std::map<std::string, std::vector<fs::path>> overlay_layers;
@@ -113,9 +455,11 @@ MountPlan generate_plan(const Config& config, const std::vector<Module>& modules
     for (const auto& module : modules) {
         fs::path content_path = storage_root / module.id;
 
-        if (!fs::exists(content_path))
+        auto scan_it = scan_index.modules.find(module.id);
+        if (scan_it == scan_index.modules.end())
             continue;
-        if (!has_meaningful_content(content_path, target_partitions))
+        const ModuleScan& scan = scan_it->second;
+        if (!scan.has_content())
             continue;
 
         // Determine default mode
@@ -144,10 +488,10 @@ MountPlan generate_plan(const Config& config, const std::vector<Module>& modules
                 // Fallback to OverlayFS or Forced OverlayFS
                 bool participates_in_overlay = false;
                 for (const auto& part : target_partitions) {
-                    fs::path part_path = content_path / part;
-                    if (fs::is_directory(part_path) && has_files(part_path)) {
+                    auto part_it = scan.partitions.find(part);
+                    if (part_it != scan.partitions.end() && !part_it->second.empty()) {
                         std::string part_root = "/" + part;
-                        overlay_layers[part_root].push_back(part_path);
+                        overlay_layers[part_root].push_back(content_path / part);
                         participates_in_overlay = true;
                     }
                 }
@@ -161,68 +505,40 @@ MountPlan generate_plan(const Config& config, const std::vector<Module>& modules
             bool overlay_active = false;
             bool magic_active = false;
 
+            PathPrefixMatcher rule_matcher = build_rule_matcher(module);
+
             for (const auto& part : target_partitions) {
-                fs::path part_root = content_path / part;
-                if (!fs::exists(part_root))
+                auto part_it = scan.partitions.find(part);
+                if (part_it == scan.partitions.end())
                     continue;
 
-                for (const auto& entry : fs::recursive_directory_iterator(part_root)) {
-                    fs::path rel = fs::relative(entry.path(), content_path);
-                    std::string path_str = "/" + rel.string();
-
-                    std::string mode = default_mode;
-                    size_t max_len = 0;
-                    bool rule_found = false;
-
-                    for (const auto& rule : module.rules) {
-                        if (path_str == rule.path ||
-                            (path_str.size() > rule.path.size() &&
-                             path_str.compare(0, rule.path.size(), rule.path) == 0 &&
-                             path_str[rule.path.size()] == '/')) {
-                            if (rule.path.size() > max_len) {
-                                max_len = rule.path.size();
-                                mode = rule.mode;
-                                rule_found = true;
-                            }
-                        }
-                    }
+                for (const ScanEntry& entry : part_it->second) {
+                    const std::string& path_str = entry.rel;
+
+                    int rule_idx = rule_matcher.match(path_str);
+                    std::string mode =
+                        rule_idx >= 0 ? module.rules[rule_idx].mode : default_mode;
 
                     if (mode == "none")
                         continue;
 
-                    if (entry.is_directory()) {
-                        if (mode == "overlay") {
-                            bool is_exact_rule = false;
-                            for (const auto& rule : module.rules) {
-                                if (rule.path == path_str && rule.mode == "overlay") {
-                                    is_exact_rule = true;
-                                    break;
-                                }
-                            }
+                    // Exact-path rule: the longest match covers the path itself
+                    bool is_exact_rule =
+                        rule_idx >= 0 && module.rules[rule_idx].path == path_str;
 
+                    if (entry.stat_type == DT_DIR) {
+                        if (mode == "overlay") {
                             if (is_exact_rule) {
-                                overlay_layers[path_str].push_back(entry.path());
+                                overlay_layers[path_str].push_back(entry.abs);
                                 overlay_active = true;
-                            } else if (!rule_found && default_mode == "overlay") {
-                                if (entry.path() == part_root) {
-                                    overlay_layers["/" + part].push_back(entry.path());
-                                    overlay_active = true;
-                                }
                             }
                         } else if (mode == "magic") {
-                            bool is_exact_rule = false;
-                            for (const auto& rule : module.rules) {
-                                if (rule.path == path_str && rule.mode == "magic") {
-                                    is_exact_rule = true;
-                                    break;
-                                }
-                            }
                             if (is_exact_rule) {
-                                magic_paths.insert(entry.path());
+                                magic_paths.insert(entry.abs);
                                 magic_active = true;
                             }
                         } else if (mode == "hymofs") {
-                            // Will be handled by update_hymofs_mappings
+                            // Will be handled by the rule-emission phase
                         }
                     }
 
@@ -277,31 +593,23 @@ MountPlan generate_plan(const Config& config, const std::vector<Module>& modules
     plan.overlay_module_ids.assign(overlay_ids.begin(), overlay_ids.end());
     plan.magic_module_ids.assign(magic_ids.begin(), magic_ids.end());
 
+    compose_overlay_layers(plan, storage_root);
+
     return plan;
 }
 
-struct AddRule {
-    std::string src;
-    std::string target;
-    int type;
-};
-
-void update_hymofs_mappings(const Config& config, const std::vector<Module>& modules,
-                            const fs::path& storage_root, MountPlan& plan) {
-    if (!HymoFS::is_available())
-        return;
-
-    // Clear existing mappings
-    HymoFS::clear_rules();
-
+HymoFSRuleSet emit_hymofs_rules(const Config& config, const std::vector<Module>& modules,
+                                const fs::path& storage_root, MountPlan& plan,
+                                const ModuleScanIndex& scan_index) {
+    ScopedTimer timer("hymofs_emit");
     std::vector<std::string> target_partitions = BUILTIN_PARTITIONS;
     for (const auto& part : config.partitions) {
         target_partitions.push_back(part);
     }
 
-    std::vector<AddRule> add_rules;
-    std::vector<AddRule> merge_rules;
-    std::vector<std::string> hide_rules;
+    HymoFSRuleSet add_rules;
+    HymoFSRuleSet merge_rules;
+    HymoFSRuleSet hide_rules;
 
     // Process explicit hide rules from module configuration
     for (const auto& module : modules) {
@@ -317,7 +625,8 @@ void update_hymofs_mappings(const Config& config, const std::vector<Module>& mod
 
         for (const auto& rule : module.rules) {
             if (rule.mode == "hide") {
-                hide_rules.push_back(resolve_path_for_hymofs(rule.path));
+                hide_rules.push_back({resolve_path_for_hymofs(rule.path), "", 0,
+                                      HYMO_BATCH_OP_HIDE, module.id});
             }
         }
     }
@@ -339,152 +648,233 @@ void update_hymofs_mappings(const Config& config, const std::vector<Module>& mod
 
         fs::path mod_path = storage_root / module.id;
 
+        auto scan_it = scan_index.modules.find(module.id);
+        if (scan_it == scan_index.modules.end())
+            continue;
+        const ModuleScan& scan = scan_it->second;
+
         // Determine default mode for this module
         std::string default_mode = module.mode;
         if (default_mode == "auto")
             default_mode = "hymofs";  // If it's in hymofs_module_ids, default is
                                       // effectively hymofs unless overridden
 
+        PathPrefixMatcher rule_matcher = build_rule_matcher(module);
+        PathPrefixMatcher overlay_matcher = plan.build_overlay_matcher();
+
         for (const auto& part : target_partitions) {
-            fs::path part_root = mod_path / part;
-            if (!fs::exists(part_root))
+            auto part_it = scan.partitions.find(part);
+            if (part_it == scan.partitions.end())
                 continue;
+            const std::vector<ScanEntry>& entries = part_it->second;
 
-            try {
-                for (auto dir_it = fs::recursive_directory_iterator(part_root);
-                     dir_it != fs::recursive_directory_iterator(); ++dir_it) {
-                    const auto& entry = *dir_it;
-                    fs::path rel = fs::relative(entry.path(), mod_path);
-                    fs::path virtual_path = fs::path("/") / rel;
-                    std::string path_str = virtual_path.string();
-
-                    // Check rules
-                    std::string mode = default_mode;
-                    size_t max_len = 0;
-                    for (const auto& rule : module.rules) {
-                        if (path_str == rule.path ||
-                            (path_str.size() > rule.path.size() &&
-                             path_str.compare(0, rule.path.size(), rule.path) == 0 &&
-                             path_str[rule.path.size()] == '/')) {
-                            if (rule.path.size() > max_len) {
-                                max_len = rule.path.size();
-                                mode = rule.mode;
-                            }
-                        }
-                    }
+            for (size_t idx = 0; idx < entries.size(); idx++) {
+                const ScanEntry& entry = entries[idx];
+                const std::string& path_str = entry.rel;
 
-                    // If mode is NOT hymofs, skip this file
-                    if (mode != "hymofs" && mode != "auto") {
-                        continue;
-                    }
+                // Check rules
+                int rule_idx = rule_matcher.match(path_str);
+                std::string mode = rule_idx >= 0 ? module.rules[rule_idx].mode : default_mode;
+
+                // If mode is NOT hymofs, skip this file
+                if (mode != "hymofs" && mode != "auto") {
+                    continue;
+                }
 
-                    // Check if covered by overlay
-                    bool covered = false;
-                    // Use reference to allow modification of lowerdirs
-                    for (auto& op : plan.overlay_ops) {
-                        std::string p_str = virtual_path.string();
-                        std::string t_str = op.target;
-
-                        bool match =
-                            (p_str == t_str) || (p_str.size() > t_str.size() &&
-                                                 p_str.compare(0, t_str.size(), t_str) == 0 &&
-                                                 p_str[t_str.size()] == '/');
-
-                        if (match) {
-                            covered = true;
-                            // Add layer if not present
-                            if (t_str.size() > 1) {
-                                fs::path layer_path = mod_path / t_str.substr(1);
-                                bool exists = false;
-                                for (const auto& l : op.lowerdirs) {
-                                    if (l == layer_path) {
-                                        exists = true;
-                                        break;
-                                    }
-                                }
-                                if (!exists && fs::exists(layer_path)) {
-                                    op.lowerdirs.push_back(layer_path);
-                                }
+                // Check if covered by overlay (deepest matching op wins)
+                int op_idx = overlay_matcher.match(path_str);
+                if (op_idx >= 0) {
+                    OverlayOperation& op = plan.overlay_ops[op_idx];
+                    // Add layer if not present
+                    if (op.target.size() > 1) {
+                        fs::path layer_path = mod_path / op.target.substr(1);
+                        bool exists = false;
+                        for (const auto& l : op.lowerdirs) {
+                            if (l == layer_path) {
+                                exists = true;
+                                break;
                             }
-                            break;
+                        }
+                        if (!exists && fs::exists(layer_path)) {
+                            op.lowerdirs.push_back(layer_path);
                         }
                     }
+                    continue;
+                }
 
-                    if (covered) {
+                if (entry.stat_type == DT_DIR) {
+                    std::string final_virtual_path = resolve_path_for_hymofs(path_str);
+                    if (fs::exists(final_virtual_path) && fs::is_directory(final_virtual_path)) {
+                        merge_rules.push_back({final_virtual_path, entry.abs, DT_DIR,
+                                               HYMO_BATCH_OP_MERGE, module.id});
+                        // Kernel handles children via merge: skip the
+                        // subtree, which directly follows in DFS order
+                        std::string prefix = path_str + "/";
+                        while (idx + 1 < entries.size() &&
+                               entries[idx + 1].rel.compare(0, prefix.size(), prefix) == 0) {
+                            idx++;
+                        }
                         continue;
                     }
+                }
 
-                    if (entry.is_directory()) {
-                        std::string final_virtual_path =
-                            resolve_path_for_hymofs(virtual_path.string());
-                        if (fs::exists(final_virtual_path) &&
-                            fs::is_directory(final_virtual_path)) {
-                            merge_rules.push_back(
-                                {final_virtual_path, entry.path().string(), DT_DIR});
-                            dir_it.disable_recursion_pending();  // Kernel handles children via
-                                                                 // merge
+                if (entry.stat_type == DT_REG || entry.dt_type == DT_LNK) {
+                    // Safety Check: Do not replace existing directories with symlinks
+                    if (entry.dt_type == DT_LNK) {
+                        if (fs::exists(path_str) && fs::is_directory(path_str)) {
+                            LOG_WARN("Safety: Skipping symlink replacement for directory: " +
+                                     path_str);
                             continue;
                         }
                     }
-
-                    if (entry.is_regular_file() || entry.is_symlink()) {
-                        // Safety Check: Do not replace existing directories with symlinks
-                        if (entry.is_symlink()) {
-                            if (fs::exists(virtual_path) && fs::is_directory(virtual_path)) {
-                                LOG_WARN("Safety: Skipping symlink replacement for directory: " +
-                                         virtual_path.string());
-                                continue;
-                            }
-                        }
-                        int type = DT_UNKNOWN;
-                        if (entry.is_regular_file())
-                            type = DT_REG;
-                        else if (entry.is_symlink())
-                            type = DT_LNK;
-                        else if (entry.is_directory())
-                            type = DT_DIR;
-                        else if (entry.is_block_file())
-                            type = DT_BLK;
-                        else if (entry.is_character_file())
-                            type = DT_CHR;
-                        else if (entry.is_fifo())
-                            type = DT_FIFO;
-                        else if (entry.is_socket())
-                            type = DT_SOCK;
-
-                        std::string final_virtual_path =
-                            resolve_path_for_hymofs(virtual_path.string());
-                        add_rules.push_back({final_virtual_path, entry.path().string(), type});
-                    } else if (entry.is_character_file()) {
-                        // Check for whiteout (0:0)
-                        struct stat st;
-                        if (stat(entry.path().c_str(), &st) == 0) {
-                            if (major(st.st_rdev) == 0 && minor(st.st_rdev) == 0) {
-                                hide_rules.push_back(
-                                    resolve_path_for_hymofs(virtual_path.string()));
-                            }
-                        }
-                    }
+                    int type = DT_UNKNOWN;
+                    if (entry.stat_type == DT_REG)
+                        type = DT_REG;
+                    else if (entry.dt_type == DT_LNK)
+                        type = DT_LNK;
+
+                    std::string final_virtual_path = resolve_path_for_hymofs(path_str);
+                    add_rules.push_back(
+                        {final_virtual_path, entry.abs, type, HYMO_BATCH_OP_ADD, module.id});
+                } else if (entry.whiteout) {
+                    hide_rules.push_back({resolve_path_for_hymofs(path_str), "", 0,
+                                          HYMO_BATCH_OP_HIDE, module.id});
                 }
-            } catch (const std::exception& e) {
-                LOG_WARN("Error scanning module " + module.id + ": " + std::string(e.what()));
             }
         }
     }
 
-    // Apply rules: Add files first (auto-injects parents), then hide
-    for (const auto& rule : add_rules) {
-        HymoFS::add_rule(rule.src, rule.target, rule.type);
+    // Rule order matters: add files first (auto-injects parents), merges
+    // next, hides last
+    HymoFSRuleSet rule_set;
+    rule_set.reserve(add_rules.size() + merge_rules.size() + hide_rules.size());
+    std::move(add_rules.begin(), add_rules.end(), std::back_inserter(rule_set));
+    std::move(merge_rules.begin(), merge_rules.end(), std::back_inserter(rule_set));
+    std::move(hide_rules.begin(), hide_rules.end(), std::back_inserter(rule_set));
+    return rule_set;
+}
+
+static const char* batch_op_verb(int op) {
+    switch (op) {
+    case HYMO_BATCH_OP_MERGE:
+        return "MERGE";
+    case HYMO_BATCH_OP_HIDE:
+        return "HIDE";
+    default:
+        return "ADD";
+    }
+}
+
+// Identity of one kernel rule: verb + virtual path + backing path.
+// 0x1f never occurs in paths, so concatenation is unambiguous.
+static std::string rule_key(const std::string& verb, const std::string& virt,
+                            const std::string& backing) {
+    return verb + '\x1f' + virt + '\x1f' + backing;
+}
+
+// Diff the desired table against what the kernel reports and submit only
+// the delta, so a hot-mount of one module costs O(that module) and the
+// rules of untouched modules never leave the table. Returns false when
+// the active set cannot be read or the diff would be ambiguous; the
+// caller then falls back to a full rebuild.
+static bool apply_rules_diff(const std::vector<HymoBatchRule>& desired) {
+    std::set<std::string> wanted;
+    std::map<std::string, int> src_refs;  // virtual path -> desired rule count
+    for (const auto& rule : desired) {
+        bool hide = rule.op == HYMO_BATCH_OP_HIDE;
+        wanted.insert(rule_key(batch_op_verb(rule.op), rule.src, hide ? "" : rule.target));
+        src_refs[rule.src]++;
+    }
+
+    // Deletion is keyed by virtual path only. Two desired rules sharing a
+    // path (conflicting modules resolved by submission order) cannot be
+    // diffed safely — rebuild instead.
+    for (const auto& [src, refs] : src_refs) {
+        if (refs > 1)
+            return false;
+    }
+
+    std::set<std::string> active;
+    std::vector<std::string> stale;  // virtual paths to delete
+    bool listed = HymoFS::list_active_rules([&](const HymoActiveRule& rule) {
+        std::string key;
+        std::string virt;
+        if (rule.type == "ADD" || rule.type == "MERGE") {
+            virt = rule.target;
+            key = rule_key(rule.type, rule.target, rule.source);
+        } else if (rule.type == "HIDE") {
+            virt = rule.path;
+            key = rule_key(rule.type, rule.path, "");
+        } else {
+            return;  // informational lines are never ours to remove
+        }
+
+        active.insert(key);
+        if (wanted.find(key) == wanted.end())
+            stale.push_back(virt);
+    });
+    if (!listed)
+        return false;
+
+    std::vector<HymoBatchRule> additions;
+    for (const auto& rule : desired) {
+        bool hide = rule.op == HYMO_BATCH_OP_HIDE;
+        if (active.find(rule_key(batch_op_verb(rule.op), rule.src, hide ? "" : rule.target)) ==
+            active.end()) {
+            additions.push_back(rule);
+        }
+    }
+
+    // Deleting a stale path whose desired replacement is already in the
+    // kernel would drop both (deletion is keyed by path alone). A stale
+    // path that is only re-added by this delta is fine: deletions run
+    // before additions.
+    std::set<std::string> readded;
+    for (const auto& rule : additions) {
+        readded.insert(rule.src);
     }
-    for (const auto& rule : merge_rules) {
-        HymoFS::add_merge_rule(rule.src, rule.target);
+    for (const auto& virt : stale) {
+        if (src_refs.find(virt) != src_refs.end() && readded.find(virt) == readded.end())
+            return false;
     }
-    for (const auto& path : hide_rules) {
-        HymoFS::hide_path(path);
+
+    for (const auto& src : stale) {
+        if (!HymoFS::delete_rule(src))
+            return false;
     }
+    if (!additions.empty() && !HymoFS::add_rules_batch(additions))
+        return false;
 
-    // Apply user-defined hide rules
-    apply_user_hide_rules();
+    LOG_INFO("HymoFS rule diff: " + std::to_string(additions.size()) + " added, " +
+             std::to_string(stale.size()) + " removed, " +
+             std::to_string(desired.size() - additions.size()) + " unchanged");
+    return true;
+}
+
+void apply_hymofs_rules(const Config& config, const HymoFSRuleSet& rule_set) {
+    if (!HymoFS::is_available())
+        return;
+    ScopedTimer timer("hymofs_apply");
+    telemetry_note_rule_count(rule_set.size());
+
+    // Desired kernel table: the plan's rules plus the user hide rules
+    // that were previously re-applied after every rebuild
+    std::vector<HymoBatchRule> desired;
+    desired.reserve(rule_set.size());
+    for (const auto& rule : rule_set) {
+        desired.push_back({rule.src, rule.target, rule.type, rule.op});
+    }
+    for (const auto& user_rule : load_user_hide_rules()) {
+        desired.push_back({user_rule.path, "", 0, HYMO_BATCH_OP_HIDE});
+    }
+
+    if (!apply_rules_diff(desired)) {
+        // Listing unavailable or diff ambiguous: tear down and resubmit
+        // everything as one batch, as before
+        LOG_INFO("HymoFS rule diff not applicable, rebuilding table");
+        HymoFS::clear_rules();
+        HymoFS::add_rules_batch(desired);
+    }
 
     // Restore enabled state (CLEAR_ALL must not disable; re-apply in case of old kernel)
     HymoFS::set_enabled(config.hymofs_enabled);
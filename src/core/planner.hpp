@@ -2,6 +2,7 @@
 #pragma once
 
 #include "../conf/config.hpp"
+#include "../mount/hymofs.hpp"
 #include "inventory.hpp"
 #include <filesystem>
 #include <map>
@@ -17,6 +18,24 @@ struct OverlayOperation {
       lowerdirs; // Ordered from top to bottom (higher priority first)
 };
 
+// Path-component trie for longest-prefix matching. Built once per rule set,
+// queried in O(path depth) instead of O(rules) per file.
+class PathPrefixMatcher {
+public:
+  void insert(const std::string &path, int value);
+  // Value of the deepest inserted prefix covering path (on '/' component
+  // boundaries), or -1 when nothing matches. First insert wins on duplicates,
+  // mirroring the old first-rule-of-equal-length behaviour.
+  int match(const std::string &path) const;
+
+private:
+  struct TrieNode {
+    std::map<std::string, TrieNode> children;
+    int value = -1;
+  };
+  TrieNode root_;
+};
+
 struct MountPlan {
   std::vector<OverlayOperation> overlay_ops;
   std::vector<fs::path> magic_module_paths;
@@ -25,14 +44,63 @@ struct MountPlan {
   std::vector<std::string> hymofs_module_ids;
 
   bool is_covered_by_overlay(const std::string &path) const;
+  // Matcher over overlay op targets; match() yields the op index
+  PathPrefixMatcher build_overlay_matcher() const;
+};
+
+// One filesystem object discovered while scanning a module's content
+struct ScanEntry {
+  std::string rel;  // virtual path relative to the module root ("/system/...")
+  std::string abs;  // absolute path inside the storage root
+  int dt_type;      // DT_* as lstat reports it
+  int stat_type;    // DT_* after following symlinks (differs only for DT_LNK)
+  bool whiteout;    // character device 0:0
+};
+
+// Per-module scan result: entries per partition, in DFS order so a
+// subtree occupies a contiguous range after its directory entry
+struct ModuleScan {
+  std::map<std::string, std::vector<ScanEntry>> partitions;
+
+  bool has_content() const;
 };
 
+// Shared tree index built once per boot and consumed by both the
+// mode-classification and rule-emission phases, so each module tree is
+// walked a single time
+struct ModuleScanIndex {
+  std::map<std::string, ModuleScan> modules;
+};
+
+ModuleScanIndex build_module_scan_index(const Config &config,
+                                        const std::vector<Module> &modules,
+                                        const fs::path &storage_root);
+
 MountPlan generate_plan(const Config &config,
                         const std::vector<Module> &modules,
-                        const fs::path &storage_root);
+                        const fs::path &storage_root,
+                        const ModuleScanIndex &scan_index);
+
+// One emitted HymoFS rule, tagged with the module it came from
+struct HymoFSRule {
+  std::string src;
+  std::string target;
+  int type = 0;
+  int op = HYMO_BATCH_OP_ADD;
+  std::string module_id;
+};
+
+using HymoFSRuleSet = std::vector<HymoFSRule>;
+
+// Walk the scan index and compute the rule set for all HymoFS modules.
+// Also extends overlay op lowerdirs in the plan for overlay-covered paths.
+HymoFSRuleSet emit_hymofs_rules(const Config &config,
+                                const std::vector<Module> &modules,
+                                const fs::path &storage_root, MountPlan &plan,
+                                const ModuleScanIndex &scan_index);
 
-void update_hymofs_mappings(const Config &config,
-                            const std::vector<Module> &modules,
-                            const fs::path &storage_root, MountPlan &plan);
+// Submit a previously emitted rule set to the kernel (clear + batch add),
+// then re-apply user hide rules and the enabled state
+void apply_hymofs_rules(const Config &config, const HymoFSRuleSet &rule_set);
 
 } // namespace hymo
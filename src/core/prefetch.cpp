@@ -0,0 +1,259 @@
+// core/prefetch.cpp - Page cache warm-up for mounted module content
+#include "prefetch.hpp"
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+#include "../defs.hpp"
+#include "../utils.hpp"
+
+namespace hymo {
+
+// Boots-seen counter per file. There is no kernel access tracing here,
+// so "survived many boots" stands in for "frequently used": long-lived
+// module content (fonts, libs) outranks files from a module installed
+// yesterday. Entries that disappear decay and eventually drop out.
+static const char* PREFETCH_LOG_NAME = "prefetch_log.tsv";
+
+// Per-module ordering hints distilled from the log above
+static const char* MODULE_PRIORITY_LOG_NAME = "module_priority.tsv";
+
+static constexpr int PREFETCH_MAX_SEEN = 64;
+
+struct PrefetchCandidate {
+    std::string path;
+    uint64_t size = 0;
+    int seen = 0;
+};
+
+static fs::path prefetch_log_path() {
+    return fs::path(RUN_DIR) / PREFETCH_LOG_NAME;
+}
+
+static void load_prefetch_log(std::map<std::string, int>& out) {
+    std::ifstream in(prefetch_log_path());
+    if (!in.is_open())
+        return;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        int seen = 0;
+        char path_buf[4096];
+        // Path is last so it may contain spaces
+        if (sscanf(line.c_str(), "%d\t%4095[^\n]", &seen, path_buf) == 2) {
+            out[path_buf] = seen;
+        }
+    }
+}
+
+static void save_prefetch_log(const std::map<std::string, int>& log) {
+    std::ofstream outf(prefetch_log_path(), std::ios::trunc);
+    if (!outf.is_open())
+        return;
+
+    for (const auto& [path, seen] : log) {
+        if (seen > 0)
+            outf << seen << "\t" << path << "\n";
+    }
+}
+
+static fs::path module_priority_path() {
+    return fs::path(RUN_DIR) / MODULE_PRIORITY_LOG_NAME;
+}
+
+std::map<std::string, int> load_module_priorities() {
+    std::map<std::string, int> out;
+
+    std::ifstream in(module_priority_path());
+    if (!in.is_open())
+        return out;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        int score = 0;
+        char id_buf[256];
+        if (sscanf(line.c_str(), "%d\t%255[^\n]", &score, id_buf) == 2) {
+            out[id_buf] = score;
+        }
+    }
+    return out;
+}
+
+// Aggregate the per-file boots-seen counts into one score per module:
+// a module whose files keep surviving boots is the content users touch
+static void save_module_priorities(const std::map<std::string, int>& file_log,
+                                   const fs::path& storage_root) {
+    std::string root = storage_root.string();
+    while (!root.empty() && root.back() == '/')
+        root.pop_back();
+    if (root.empty())
+        return;
+
+    std::map<std::string, int> scores;
+    for (const auto& [path, seen] : file_log) {
+        if (path.size() <= root.size() + 1 || path.compare(0, root.size(), root) != 0 ||
+            path[root.size()] != '/') {
+            continue;
+        }
+        size_t id_start = root.size() + 1;
+        size_t slash = path.find('/', id_start);
+        if (slash == std::string::npos)
+            continue;
+        scores[path.substr(id_start, slash - id_start)] += seen;
+    }
+
+    std::ofstream outf(module_priority_path(), std::ios::trunc);
+    if (!outf.is_open())
+        return;
+    for (const auto& [id, score] : scores) {
+        outf << score << "\t" << id << "\n";
+    }
+}
+
+// Collect regular files with content under root, deduplicated
+static void collect_files(const fs::path& root, std::set<std::string>& out) {
+    std::error_code ec;
+    if (!fs::is_directory(root, ec))
+        return;
+
+    try {
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            std::error_code sec;
+            if (entry.is_regular_file(sec) && !entry.is_symlink(sec) &&
+                entry.file_size(sec) > 0) {
+                out.insert(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_DEBUG("Prefetch scan failed for " + root.string());
+    }
+}
+
+// Ask the kernel to read the file in; one open + fadvise per file
+static bool advise_file(const std::string& path, uint64_t size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    int rc = posix_fadvise(fd, 0, (off_t)size, POSIX_FADV_WILLNEED);
+    close(fd);
+    return rc == 0;
+}
+
+// The actual warm-up, running in the detached grandchild
+static void run_prefetch(const std::vector<fs::path>& roots, uint64_t budget_bytes,
+                         const fs::path& storage_root) {
+    // Background work: stay out of the way of app launches
+    setpriority(PRIO_PROCESS, 0, 10);
+
+    std::set<std::string> files;
+    for (const auto& root : roots) {
+        collect_files(root, files);
+    }
+    if (files.empty())
+        return;
+
+    std::map<std::string, int> log;
+    load_prefetch_log(log);
+
+    std::vector<PrefetchCandidate> candidates;
+    candidates.reserve(files.size());
+    for (const auto& path : files) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+        PrefetchCandidate c;
+        c.path = path;
+        c.size = (uint64_t)st.st_size;
+        auto it = log.find(path);
+        c.seen = it != log.end() ? it->second : 0;
+        candidates.push_back(std::move(c));
+    }
+
+    // Veterans first; among equals, small files give the most cache
+    // entries per budget byte
+    std::sort(candidates.begin(), candidates.end(),
+              [](const PrefetchCandidate& a, const PrefetchCandidate& b) {
+                  if (a.seen != b.seen)
+                      return a.seen > b.seen;
+                  if (a.size != b.size)
+                      return a.size < b.size;
+                  return a.path < b.path;
+              });
+
+    uint64_t spent = 0;
+    for (const auto& c : candidates) {
+        if (spent + c.size > budget_bytes)
+            continue;  // later smaller files may still fit
+        if (advise_file(c.path, c.size))
+            spent += c.size;
+    }
+
+    // Age the log: everything present this boot goes up (capped),
+    // vanished entries decay toward removal
+    std::map<std::string, int> updated;
+    for (const auto& c : candidates) {
+        updated[c.path] = std::min(c.seen + 1, PREFETCH_MAX_SEEN);
+    }
+    for (const auto& [path, seen] : log) {
+        if (updated.find(path) == updated.end() && seen > 1) {
+            updated[path] = seen - 1;
+        }
+    }
+    save_prefetch_log(updated);
+
+    // Refresh the ordering hints the schedulers read next boot
+    save_module_priorities(updated, storage_root);
+}
+
+void start_prefetch(const MountPlan& plan, const fs::path& storage_root, const Config& config) {
+    if (!config.prefetch || config.prefetch_budget_mb <= 0)
+        return;
+
+    std::vector<fs::path> roots;
+    for (const auto& op : plan.overlay_ops) {
+        for (const auto& lower : op.lowerdirs) {
+            roots.push_back(lower);
+        }
+    }
+    for (const auto& path : plan.magic_module_paths) {
+        roots.push_back(path);
+    }
+    for (const auto& id : plan.hymofs_module_ids) {
+        roots.push_back(storage_root / id);
+    }
+    if (roots.empty())
+        return;
+
+    uint64_t budget_bytes = (uint64_t)config.prefetch_budget_mb * 1024 * 1024;
+
+    // Same double-fork as the deferred EROFS rebuild: the grandchild is
+    // reparented to init and outlives this CLI invocation
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_WARN("Prefetch: fork failed: " + std::string(strerror(errno)));
+        return;
+    }
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+        LOG_INFO("Prefetch started in background (" + std::to_string(roots.size()) +
+                 " roots, budget " + std::to_string(config.prefetch_budget_mb) + " MB)");
+        return;
+    }
+
+    if (fork() == 0) {
+        setsid();
+        run_prefetch(roots, budget_bytes, storage_root);
+    }
+    _exit(0);
+}
+
+}  // namespace hymo
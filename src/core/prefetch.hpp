@@ -0,0 +1,28 @@
+// core/prefetch.hpp - Page cache warm-up for mounted module content
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include "../conf/config.hpp"
+#include "planner.hpp"
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+// Warm the page cache for the files the plan just made visible: overlay
+// lowerdirs, magic module trees and HymoFS-backed module storage. Runs
+// in a detached background process so boot is never delayed; honors
+// config.prefetch_budget_mb and orders files by how many previous boots
+// they survived (stable content first, run/prefetch_log.tsv).
+void start_prefetch(const MountPlan& plan, const fs::path& storage_root, const Config& config);
+
+// Ordering hints the prefetch worker persisted last boot: per-module
+// sums of the boots-seen counts (run/module_priority.tsv). Consumed by
+// work schedulers (sync order, overlay spawn order) so the most
+// user-visible modules go first; precedence-bearing orders — the module
+// list and HymoFS rule submission — never change based on these.
+std::map<std::string, int> load_module_priorities();
+
+}  // namespace hymo
@@ -1,142 +1,299 @@
 // core/state.cpp - Runtime state implementation
 #include "state.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include "../defs.hpp"
 #include "../utils.hpp"
+#include "json.hpp"
+#include "json_writer.hpp"
 
 namespace hymo {
 
-bool RuntimeState::save() const {
-    ensure_dir_exists(fs::path(STATE_FILE).parent_path());
+// ---- Binary state format ----
+//
+// State is loaded on every API poll, so the hot path is a single small
+// read of a fixed-layout file instead of a line-by-line JSON parse. The
+// header carries the counts; a NUL-separated string table follows with
+// storage_mode, mount_point, mismatch_message and then the four id
+// lists in header order. Bump STATE_VERSION on any layout change.
 
-    std::ofstream file(STATE_FILE);
-    if (!file.is_open()) {
-        LOG_ERROR("Failed to save runtime state");
+static constexpr uint32_t STATE_MAGIC = 0x53525948;  // "HYRS"
+static constexpr uint32_t STATE_VERSION = 1;
+
+// Sanity cap for the string table; real state files are a few hundred bytes
+static constexpr uint32_t STATE_MAX_STRTAB = 1 << 20;
+
+struct StateFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    uint8_t nuke_active;
+    uint8_t hymofs_mismatch;
+    uint16_t reserved;
+    uint32_t list_counts[4];  // overlay, magic, hymofs, active_mounts
+    uint32_t strtab_len;
+};
+
+static void append_cstr(std::string& strtab, const std::string& s) {
+    strtab.append(s);
+    strtab.push_back('\0');
+}
+
+// Pull the next NUL-terminated string out of the table; false on overrun
+static bool next_cstr(const char* strtab, size_t len, size_t& off, std::string& out) {
+    if (off >= len)
         return false;
-    }
+    size_t end = off;
+    while (end < len && strtab[end] != '\0')
+        end++;
+    if (end >= len)
+        return false;  // unterminated
+    out.assign(strtab + off, end - off);
+    off = end + 1;
+    return true;
+}
 
-    file << "{\n";
-    file << "  \"storage_mode\": \"" << storage_mode << "\",\n";
-    file << "  \"mount_point\": \"" << mount_point << "\",\n";
-    file << "  \"nuke_active\": " << (nuke_active ? "true" : "false") << ",\n";
-    file << "  \"hymofs_mismatch\": " << (hymofs_mismatch ? "true" : "false") << ",\n";
-    file << "  \"mismatch_message\": \"" << mismatch_message << "\",\n";
-
-    file << "  \"overlay_module_ids\": [";
-    for (size_t i = 0; i < overlay_module_ids.size(); ++i) {
-        file << "\"" << overlay_module_ids[i] << "\"";
-        if (i < overlay_module_ids.size() - 1)
-            file << ", ";
-    }
-    file << "],\n";
+std::string RuntimeState::to_json() const {
+    // Pretty-printed so mount_point stays on its own line for the
+    // uninstall scripts' grep
+    json::Writer w(1024, 2);
+
+    auto emit_array = [&w](const char* key, const std::vector<std::string>& items) {
+        w.key(key).begin_array();
+        for (const auto& item : items)
+            w.value(item);
+        w.end_array();
+    };
+
+    w.begin_object();
+    w.key("storage_mode").value(storage_mode);
+    w.key("mount_point").value(mount_point);
+    w.key("nuke_active").value(nuke_active);
+    w.key("hymofs_mismatch").value(hymofs_mismatch);
+    w.key("mismatch_message").value(mismatch_message);
+    emit_array("overlay_module_ids", overlay_module_ids);
+    emit_array("magic_module_ids", magic_module_ids);
+    emit_array("hymofs_module_ids", hymofs_module_ids);
+    emit_array("active_mounts", active_mounts);
+    w.key("pid").value(pid);
+    w.end_object();
+
+    return w.str() + "\n";
+}
 
-    file << "  \"magic_module_ids\": [";
-    for (size_t i = 0; i < magic_module_ids.size(); ++i) {
-        file << "\"" << magic_module_ids[i] << "\"";
-        if (i < magic_module_ids.size() - 1)
-            file << ", ";
+static bool save_binary_state(const RuntimeState& state) {
+    StateFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = STATE_MAGIC;
+    header.version = STATE_VERSION;
+    header.pid = state.pid;
+    header.nuke_active = state.nuke_active ? 1 : 0;
+    header.hymofs_mismatch = state.hymofs_mismatch ? 1 : 0;
+    header.list_counts[0] = (uint32_t)state.overlay_module_ids.size();
+    header.list_counts[1] = (uint32_t)state.magic_module_ids.size();
+    header.list_counts[2] = (uint32_t)state.hymofs_module_ids.size();
+    header.list_counts[3] = (uint32_t)state.active_mounts.size();
+
+    std::string strtab;
+    append_cstr(strtab, state.storage_mode);
+    append_cstr(strtab, state.mount_point);
+    append_cstr(strtab, state.mismatch_message);
+    for (const auto& id : state.overlay_module_ids)
+        append_cstr(strtab, id);
+    for (const auto& id : state.magic_module_ids)
+        append_cstr(strtab, id);
+    for (const auto& id : state.hymofs_module_ids)
+        append_cstr(strtab, id);
+    for (const auto& mnt : state.active_mounts)
+        append_cstr(strtab, mnt);
+    header.strtab_len = (uint32_t)strtab.size();
+
+    std::string blob;
+    blob.reserve(sizeof(header) + strtab.size());
+    blob.append((const char*)&header, sizeof(header));
+    blob.append(strtab);
+
+    // One write to a temp file, then an atomic rename: readers only ever
+    // see a complete state file
+    std::string tmp_path = std::string(STATE_BIN_FILE) + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open state temp file: " + std::string(strerror(errno)));
+        return false;
     }
-    file << "],\n";
 
-    file << "  \"hymofs_module_ids\": [";
-    for (size_t i = 0; i < hymofs_module_ids.size(); ++i) {
-        file << "\"" << hymofs_module_ids[i] << "\"";
-        if (i < hymofs_module_ids.size() - 1)
-            file << ", ";
+    bool ok = pwrite(fd, blob.data(), blob.size(), 0) == (ssize_t)blob.size();
+    close(fd);
+
+    if (ok && rename(tmp_path.c_str(), STATE_BIN_FILE) != 0) {
+        LOG_ERROR("Failed to rename state file: " + std::string(strerror(errno)));
+        ok = false;
     }
-    file << "],\n";
+    if (!ok)
+        unlink(tmp_path.c_str());
+    return ok;
+}
+
+static bool load_binary_state(RuntimeState& state) {
+    int fd = open(STATE_BIN_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
 
-    file << "  \"active_mounts\": [";
-    for (size_t i = 0; i < active_mounts.size(); ++i) {
-        file << "\"" << active_mounts[i] << "\"";
-        if (i < active_mounts.size() - 1)
-            file << ", ";
+    StateFileHeader header;
+    ssize_t n = read(fd, &header, sizeof(header));
+    if (n != (ssize_t)sizeof(header) || header.magic != STATE_MAGIC ||
+        header.version != STATE_VERSION || header.strtab_len > STATE_MAX_STRTAB) {
+        close(fd);
+        return false;
     }
-    file << "],\n";
 
-    file << "  \"pid\": " << pid << "\n";
+    // Every list entry consumes at least its NUL in the string table, so
+    // the (already capped) strtab_len bounds the counts. A corrupt header
+    // must fail here and fall back to the JSON mirror, not throw inside
+    // reserve() below
+    uint64_t total_entries = 0;
+    for (uint32_t count : header.list_counts) {
+        total_entries += count;
+    }
+    if (total_entries > header.strtab_len) {
+        close(fd);
+        return false;
+    }
 
-    file << "}\n";
+    std::string strtab(header.strtab_len, '\0');
+    n = read(fd, strtab.data(), header.strtab_len);
+    close(fd);
+    if (n != (ssize_t)header.strtab_len)
+        return false;
 
-    return true;
-}
+    size_t off = 0;
+    if (!next_cstr(strtab.data(), strtab.size(), off, state.storage_mode) ||
+        !next_cstr(strtab.data(), strtab.size(), off, state.mount_point) ||
+        !next_cstr(strtab.data(), strtab.size(), off, state.mismatch_message)) {
+        return false;
+    }
 
-static std::vector<std::string> parse_json_array(const std::string& line) {
-    std::vector<std::string> result;
-    auto start = line.find("[");
-    auto end = line.find("]");
-    if (start == std::string::npos || end == std::string::npos)
-        return result;
-
-    std::string content = line.substr(start + 1, end - start - 1);
-    std::stringstream ss(content);
-    std::string item;
-    while (std::getline(ss, item, ',')) {
-        size_t first_quote = item.find("\"");
-        size_t last_quote = item.rfind("\"");
-        if (first_quote != std::string::npos && last_quote != std::string::npos &&
-            last_quote > first_quote) {
-            result.push_back(item.substr(first_quote + 1, last_quote - first_quote - 1));
+    std::vector<std::string>* lists[4] = {&state.overlay_module_ids, &state.magic_module_ids,
+                                          &state.hymofs_module_ids, &state.active_mounts};
+    for (int l = 0; l < 4; l++) {
+        lists[l]->reserve(header.list_counts[l]);
+        for (uint32_t i = 0; i < header.list_counts[l]; i++) {
+            std::string item;
+            if (!next_cstr(strtab.data(), strtab.size(), off, item))
+                return false;
+            lists[l]->push_back(std::move(item));
         }
     }
-    return result;
+
+    state.pid = header.pid;
+    state.nuke_active = header.nuke_active != 0;
+    state.hymofs_mismatch = header.hymofs_mismatch != 0;
+    return true;
 }
 
-RuntimeState load_runtime_state() {
-    RuntimeState state;
+bool RuntimeState::save() const {
+    ensure_dir_exists(fs::path(STATE_BIN_FILE).parent_path());
 
-    if (!fs::exists(STATE_FILE)) {
-        return state;
+    if (!save_binary_state(*this)) {
+        LOG_ERROR("Failed to save runtime state");
+        return false;
     }
 
+    // The uninstall scripts grep mount_point out of the JSON file, so
+    // keep writing it alongside; saves are rare, loads are the hot path
+    std::ofstream file(STATE_FILE);
+    if (file.is_open()) {
+        file << to_json();
+    } else {
+        LOG_WARN("Failed to write JSON state mirror");
+    }
+
+    return true;
+}
+
+
+// Legacy loader for state written before the binary format existed.
+// Pull-parsed; the old loader scanned line by line and silently lost
+// arrays that spanned lines.
+static void load_json_state(RuntimeState& state) {
     std::ifstream file(STATE_FILE);
     if (!file.is_open()) {
-        return state;
+        return;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        line.erase(0, line.find_first_not_of(" \t"));
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
 
-        if (line.find("\"storage_mode\"") != std::string::npos) {
-            auto start = line.find(": \"") + 3;
-            auto end = line.find("\"", start);
-            if (end != std::string::npos) {
-                state.storage_mode = line.substr(start, end - start);
-            }
-        } else if (line.find("\"mount_point\"") != std::string::npos) {
-            auto start = line.find(": \"") + 3;
-            auto end = line.find("\"", start);
-            if (end != std::string::npos) {
-                state.mount_point = line.substr(start, end - start);
-            }
-        } else if (line.find("\"nuke_active\"") != std::string::npos) {
-            state.nuke_active = line.find("true") != std::string::npos;
-        } else if (line.find("\"hymofs_mismatch\"") != std::string::npos) {
-            state.hymofs_mismatch = line.find("true") != std::string::npos;
-        } else if (line.find("\"overlay_module_ids\"") != std::string::npos) {
-            state.overlay_module_ids = parse_json_array(line);
-        } else if (line.find("\"magic_module_ids\"") != std::string::npos) {
-            state.magic_module_ids = parse_json_array(line);
-        } else if (line.find("\"hymofs_module_ids\"") != std::string::npos) {
-            state.hymofs_module_ids = parse_json_array(line);
-        } else if (line.find("\"active_mounts\"") != std::string::npos) {
-            state.active_mounts = parse_json_array(line);
-        } else if (line.find("\"pid\"") != std::string::npos) {
-            if (line.find(":") != std::string::npos) {
-                try {
-                    std::string val = line.substr(line.find(":") + 1);
-                    // Remove trailing comma if any
-                    if (val.find(",") != std::string::npos)
-                        val = val.substr(0, val.find(","));
-                    state.pid = std::stoi(val);
-                } catch (...) {
-                    state.pid = 0;
-                }
+    json::Reader reader(text);
+    if (reader.next() != json::Event::ObjectBegin) {
+        return;
+    }
+
+    json::Event ev;
+    while ((ev = reader.next()) == json::Event::Key) {
+        std::string_view key = reader.token();
+
+        if (key == "overlay_module_ids" || key == "magic_module_ids" ||
+            key == "hymofs_module_ids" || key == "active_mounts") {
+            std::vector<std::string>& list =
+                key == "overlay_module_ids"  ? state.overlay_module_ids
+                : key == "magic_module_ids"  ? state.magic_module_ids
+                : key == "hymofs_module_ids" ? state.hymofs_module_ids
+                                             : state.active_mounts;
+            if (reader.next() != json::Event::ArrayBegin)
+                break;
+            json::Event item;
+            while ((item = reader.next()) == json::Event::String) {
+                list.push_back(json::unescape(reader.token()));
             }
+            if (item != json::Event::ArrayEnd)
+                break;
+            continue;
+        }
+
+        json::Event val = reader.next();
+        if (val == json::Event::String) {
+            std::string s = json::unescape(reader.token());
+            if (key == "storage_mode")
+                state.storage_mode = s;
+            else if (key == "mount_point")
+                state.mount_point = s;
+            else if (key == "mismatch_message")
+                state.mismatch_message = s;
+        } else if (val == json::Event::Bool) {
+            if (key == "nuke_active")
+                state.nuke_active = reader.boolean();
+            else if (key == "hymofs_mismatch")
+                state.hymofs_mismatch = reader.boolean();
+        } else if (val == json::Event::Number) {
+            if (key == "pid")
+                state.pid = (int)reader.number();
+        } else if (val == json::Event::ObjectBegin || val == json::Event::ArrayBegin) {
+            if (!reader.skip_container())
+                break;
+        } else if (val == json::Event::Error || val == json::Event::End) {
+            break;
         }
     }
+}
+
+RuntimeState load_runtime_state() {
+    RuntimeState state;
+
+    if (load_binary_state(state)) {
+        return state;
+    }
+
+    // First run after an update, or a corrupt binary file: fall back to
+    // the JSON mirror
+    if (fs::exists(STATE_FILE)) {
+        load_json_state(state);
+    }
 
     return state;
 }
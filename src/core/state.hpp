@@ -19,6 +19,10 @@ struct RuntimeState {
     int pid = 0;
 
     bool save() const;
+
+    // JSON rendering for the debug command and the on-disk mirror the
+    // uninstall scripts read
+    std::string to_json() const;
 };
 
 RuntimeState load_runtime_state();
@@ -1,18 +1,26 @@
 // core/storage.cpp - Storage backend (Tmpfs/Ext4/EROFS)
 #include "storage.hpp"
 #include <fcntl.h>
+#include <linux/loop.h>
 #include <sched.h>
+#include <sys/ioctl.h>
 #include <sys/mount.h>
 #include <sys/stat.h>
 #include <sys/vfs.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include "../defs.hpp"
+#include "../dirwalk.hpp"
 #include "../utils.hpp"
-#include "json.hpp"
+#include "json_writer.hpp"
+#include "live_stats.hpp"
+#include "plan_cache.hpp"
 #include "state.hpp"
 
 #include <cinttypes>
@@ -58,9 +66,62 @@ static void repair_storage_root_permissions(const fs::path& target) {
     }
 }
 
+static uint64_t calculate_dir_size(const fs::path& path);
+
+static constexpr uint64_t IMG_MB = 1024ull * 1024;
+
+// Cap for the auto-sized image; wired to the image_max_size_mb config
+// option and matching the old fixed 2GB by default
+static int s_image_cap_mb = 2048;
+
+void set_image_size_cap_mb(int mb) {
+    if (mb > 0) {
+        s_image_cap_mb = mb;
+    }
+}
+
+// Size the image from the module footprint: 50% headroom for ext4
+// metadata and in-place module updates, floored so a near-empty module
+// dir still gets a workable image, clamped to the configured cap
+static uint64_t sized_image_bytes(const fs::path& footprint_dir) {
+    uint64_t footprint = fs::is_directory(footprint_dir) ? calculate_dir_size(footprint_dir) : 0;
+    uint64_t bytes = footprint + footprint / 2;
+    if (bytes < 256 * IMG_MB) {
+        bytes = 256 * IMG_MB;
+    }
+    uint64_t cap = (uint64_t)s_image_cap_mb * IMG_MB;
+    if (bytes > cap) {
+        bytes = cap;
+    }
+    return (bytes + IMG_MB - 1) / IMG_MB * IMG_MB;
+}
+
+// Reserve the image extent in-process: fallocate allocates blocks
+// without streaming zeros through the page cache; filesystems that
+// refuse it get a sparse ftruncate, which ext4 fills lazily anyway
+static bool allocate_image_file(const fs::path& img_file, uint64_t bytes) {
+    int fd = open(img_file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create image file: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    bool ok = fallocate(fd, 0, 0, (off_t)bytes) == 0;
+    if (!ok) {
+        LOG_DEBUG("fallocate not supported here (" + std::string(strerror(errno)) +
+                  "), using sparse ftruncate");
+        ok = ftruncate(fd, (off_t)bytes) == 0;
+    }
+    close(fd);
+
+    if (!ok) {
+        LOG_ERROR("Failed to allocate image extent: " + std::string(strerror(errno)));
+    }
+    return ok;
+}
+
 // Remove static to expose it
-bool create_image(const fs::path& base_dir) {
-    LOG_INFO("Creating modules.img...");
+bool create_image(const fs::path& base_dir, const fs::path& size_from_dir) {
     fs::path img_file = base_dir / "modules.img";
 
     // Ensure directory exists
@@ -73,22 +134,12 @@ bool create_image(const fs::path& base_dir) {
         fs::remove(img_file);
     }
 
-    // 1. Create file with dd
-    // Use dd instead of truncate for better compatibility and to avoid sparse file issues
-    // Try standard paths first
-    const char* dd_paths[] = {"/system/bin/dd", "/sbin/dd"};
-    std::string dd_bin = "dd";
-    for (const auto& p : dd_paths) {
-        if (access(p, X_OK) == 0) {
-            dd_bin = p;
-            break;
-        }
-    }
+    uint64_t image_bytes = sized_image_bytes(size_from_dir);
+    LOG_INFO("Creating modules.img (" + std::to_string(image_bytes / IMG_MB) + " MB)...");
 
-    std::string dd_cmd =
-        dd_bin + " if=/dev/zero of=" + img_file.string() + " bs=1M count=2048 >/dev/null 2>&1";
-    if (std::system(dd_cmd.c_str()) != 0) {
-        LOG_ERROR("Failed to create image file with dd (" + dd_bin + ")");
+    // 1. Allocate the extent in-process (no dd, no zero writes)
+    if (!allocate_image_file(img_file, image_bytes)) {
+        fs::remove(img_file);
         return false;
     }
 
@@ -129,26 +180,222 @@ bool create_image(const fs::path& base_dir) {
     return true;
 }
 
+// Loop device currently backed by `image_path`, via sysfs; empty when
+// the image is not attached
+static std::string find_loop_device(const fs::path& image_path) {
+    std::error_code ec;
+    fs::path canonical_img = fs::canonical(image_path, ec);
+    if (ec) {
+        canonical_img = image_path;
+    }
+
+    try {
+        for (const auto& entry : fs::directory_iterator("/sys/block")) {
+            std::string name = entry.path().filename().string();
+            if (name.compare(0, 4, "loop") != 0) {
+                continue;
+            }
+
+            std::ifstream backing(entry.path() / "loop" / "backing_file");
+            std::string backing_path;
+            if (!backing.is_open() || !std::getline(backing, backing_path)) {
+                continue;
+            }
+            if (backing_path != canonical_img.string()) {
+                continue;
+            }
+
+            std::string dev = "/dev/block/" + name;
+            if (access(dev.c_str(), F_OK) != 0) {
+                dev = "/dev/" + name;
+            }
+            return dev;
+        }
+    } catch (...) {
+        // No sysfs or unreadable: treated as not attached
+    }
+    return "";
+}
+
+void ensure_ext4_capacity(const StorageHandle& storage, const fs::path& image_path,
+                          const fs::path& source_dir) {
+    if (storage.mode != "ext4") {
+        return;
+    }
+
+    struct statfs st;
+    if (statfs(storage.mount_point.c_str(), &st) != 0) {
+        return;
+    }
+    uint64_t free_bytes = (uint64_t)st.f_bavail * st.f_bsize;
+    uint64_t total_before = (uint64_t)st.f_blocks * st.f_bsize;
+    uint64_t needed = calculate_dir_size(source_dir);
+
+    // Sync rewrites changed files in place, so most of `needed` is
+    // already resident; the slack only has to absorb growth
+    constexpr uint64_t SLACK = 64 * IMG_MB;
+    if (free_bytes >= needed + SLACK) {
+        return;
+    }
+
+    struct stat img_st;
+    if (stat(image_path.c_str(), &img_st) != 0) {
+        return;
+    }
+    uint64_t current = (uint64_t)img_st.st_size;
+    uint64_t deficit = needed + 2 * SLACK - free_bytes;
+    uint64_t new_size = (current + deficit + IMG_MB - 1) / IMG_MB * IMG_MB;
+    uint64_t cap = (uint64_t)s_image_cap_mb * IMG_MB;
+    if (new_size > cap) {
+        new_size = cap;
+    }
+    if (new_size <= current) {
+        LOG_WARN("modules.img is at its configured cap (" + std::to_string(s_image_cap_mb) +
+                 " MB) but sync needs more space");
+        return;
+    }
+
+    std::string loop_dev = find_loop_device(image_path);
+    if (loop_dev.empty()) {
+        LOG_WARN("Cannot grow modules.img: backing loop device not found");
+        return;
+    }
+
+    if (!allocate_image_file(image_path, new_size)) {
+        return;
+    }
+
+    // The kernel captured the backing file's size when the loop device
+    // was attached; without a capacity refresh resize2fs still sees the
+    // old size and exits 0 with nothing done
+    int loop_fd = open(loop_dev.c_str(), O_RDWR | O_CLOEXEC);
+    if (loop_fd < 0 || ioctl(loop_fd, LOOP_SET_CAPACITY, 0) != 0) {
+        LOG_WARN("LOOP_SET_CAPACITY failed on " + loop_dev + ": " + strerror(errno));
+        if (loop_fd >= 0) {
+            close(loop_fd);
+        }
+        return;
+    }
+    close(loop_fd);
+
+    // ext4 grows online; resize2fs picks the new size up from the
+    // refreshed loop device
+    const char* resize2fs_paths[] = {"/system/bin/resize2fs", "/sbin/resize2fs"};
+    std::string resize2fs_bin = "resize2fs";  // fallback to PATH
+    for (const auto& p : resize2fs_paths) {
+        if (access(p, X_OK) == 0) {
+            resize2fs_bin = p;
+            break;
+        }
+    }
+
+    std::string resize_cmd = resize2fs_bin + " " + loop_dev + " >/dev/null 2>&1";
+    if (std::system(resize_cmd.c_str()) != 0) {
+        LOG_WARN("resize2fs failed; modules.img stays at " + std::to_string(current / IMG_MB) +
+                 " MB");
+        return;
+    }
+
+    // resize2fs also exits 0 when it decides there is nothing to do, so
+    // trust the filesystem, not the exit code
+    struct statfs grown;
+    if (statfs(storage.mount_point.c_str(), &grown) != 0 ||
+        (uint64_t)grown.f_blocks * grown.f_bsize <= total_before) {
+        LOG_WARN("resize2fs reported success but the filesystem did not grow; modules.img "
+                 "stays at " +
+                 std::to_string(total_before / IMG_MB) + " MB usable");
+        return;
+    }
+
+    LOG_INFO("Grew modules.img online: " + std::to_string(current / IMG_MB) + " MB -> " +
+             std::to_string(new_size / IMG_MB) + " MB");
+}
+
 static bool is_erofs_available() {
     return access("/system/bin/mkfs.erofs", X_OK) == 0 ||
            access("/vendor/bin/mkfs.erofs", X_OK) == 0 || access("/sbin/mkfs.erofs", X_OK) == 0;
 }
 
-static bool create_erofs_image(const fs::path& modules_dir, const fs::path& image_path) {
-    LOG_INFO("Creating EROFS image from " + modules_dir.string());
+// Order-independent digest of the tree that feeds mkfs.erofs: relative
+// path, type and size per entry, symlink targets, and full module.prop
+// contents. Mtimes are deliberately excluded — staging trees are
+// recreated by sync each boot, so copy timestamps carry no information.
+static uint64_t digest_erofs_source(const fs::path& modules_dir) {
+    uint64_t acc = 0;
+    uint64_t count = 0;
+
+    bool walked = walk_directory(modules_dir, "", [&](const WalkEntry& e) {
+        Fnv1a h;
+        // Skip the leading '/' so the digest matches what the old
+        // fs::relative() string hashed
+        h.update(e.rel.data() + 1, e.rel.size() - 1);
+
+        struct stat st;
+        if (fstatat(e.parent_fd, e.name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            return WalkControl::Recurse;
+        h.update((uint64_t)(st.st_mode & S_IFMT));
+
+        if (S_ISREG(st.st_mode)) {
+            h.update((uint64_t)st.st_size);
+            if (strcmp(e.name, "module.prop") == 0) {
+                std::ifstream in(e.path, std::ios::binary);
+                std::stringstream buf;
+                buf << in.rdbuf();
+                h.update(buf.str());
+            }
+        } else if (S_ISLNK(st.st_mode)) {
+            std::error_code ec;
+            h.update(fs::read_symlink(e.path, ec).string());
+        }
 
-    if (!fs::exists(modules_dir)) {
-        LOG_ERROR("Modules directory not found: " + modules_dir.string());
-        return false;
+        acc ^= h.hash;
+        count++;
+        return WalkControl::Recurse;
+    });
+    if (!walked) {
+        LOG_WARN("EROFS digest walk failed: cannot open " + modules_dir.string());
+        return 0;  // never matches a recorded digest
     }
 
-    if (fs::exists(image_path)) {
-        fs::remove(image_path);
+    Fnv1a fin;
+    fin.update(acc);
+    fin.update(count);
+    return fin.hash;
+}
+
+static fs::path erofs_digest_path(const fs::path& image_path) {
+    return fs::path(image_path.string() + ".digest");
+}
+
+static bool erofs_image_fresh(const fs::path& image_path, uint64_t digest) {
+    if (digest == 0 || !fs::exists(image_path))
+        return false;
+
+    std::ifstream in(erofs_digest_path(image_path));
+    uint64_t recorded = 0;
+    if (!in.is_open() || !(in >> std::hex >> recorded))
+        return false;
+    return recorded == digest;
+}
+
+static void write_erofs_digest(const fs::path& image_path, uint64_t digest) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRIx64 "\n", digest);
+    std::ofstream out(erofs_digest_path(image_path), std::ios::trunc);
+    out << buf;
+}
+
+// Unconditional mkfs.erofs run, built to a sidecar path and renamed into
+// place so a crash mid-build never leaves a truncated image behind
+static bool build_erofs_image(const fs::path& modules_dir, const fs::path& image_path) {
+    fs::path staging_image(image_path.string() + ".new");
+    if (fs::exists(staging_image)) {
+        fs::remove(staging_image);
     }
 
     // Compress with lz4hc
     std::string cmd =
-        "mkfs.erofs -zlz4hc,9 " + image_path.string() + " " + modules_dir.string() + " 2>&1";
+        "mkfs.erofs -zlz4hc,9 " + staging_image.string() + " " + modules_dir.string() + " 2>&1";
 
     FILE* pipe = popen(cmd.c_str(), "r");
     if (!pipe) {
@@ -165,6 +412,15 @@ static bool create_erofs_image(const fs::path& modules_dir, const fs::path& imag
     int ret = pclose(pipe);
     if (WEXITSTATUS(ret) != 0) {
         LOG_ERROR("Failed to create EROFS image: " + output);
+        fs::remove(staging_image);
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(staging_image, image_path, ec);
+    if (ec) {
+        LOG_ERROR("Failed to move EROFS image into place: " + ec.message());
+        fs::remove(staging_image);
         return false;
     }
 
@@ -172,6 +428,52 @@ static bool create_erofs_image(const fs::path& modules_dir, const fs::path& imag
     return true;
 }
 
+static bool create_erofs_image(const fs::path& modules_dir, const fs::path& image_path) {
+    if (!fs::exists(modules_dir)) {
+        LOG_ERROR("Modules directory not found: " + modules_dir.string());
+        return false;
+    }
+
+    // lz4hc,9 over a large module set takes minutes on mid-range SoCs;
+    // skip the rebuild entirely when the source tree is unchanged
+    uint64_t digest = digest_erofs_source(modules_dir);
+    if (erofs_image_fresh(image_path, digest)) {
+        LOG_INFO("EROFS image up to date (digest match), skipping rebuild");
+        return true;
+    }
+
+    LOG_INFO("Creating EROFS image from " + modules_dir.string());
+    if (!build_erofs_image(modules_dir, image_path)) {
+        return false;
+    }
+    write_erofs_digest(image_path, digest);
+    return true;
+}
+
+// Rebuild the image in a detached grandchild so a stale image doesn't
+// hold up the boot path; the fresh image is picked up next boot
+static void spawn_deferred_erofs_rebuild(const fs::path& modules_dir, const fs::path& image_path) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_WARN("Deferred EROFS rebuild: fork failed: " + std::string(strerror(errno)));
+        return;
+    }
+    if (pid > 0) {
+        // Reap the intermediate child; the grandchild is init's problem
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+
+    if (fork() == 0) {
+        setsid();
+        uint64_t digest = digest_erofs_source(modules_dir);
+        if (build_erofs_image(modules_dir, image_path)) {
+            write_erofs_digest(image_path, digest);
+        }
+    }
+    _exit(0);
+}
+
 static bool try_setup_erofs(const fs::path& target, const fs::path& modules_dir,
                             const fs::path& image_path) {
     LOG_DEBUG("Attempting EROFS...");
@@ -198,8 +500,10 @@ static bool try_setup_erofs(const fs::path& target, const fs::path& modules_dir,
     return true;
 }
 
+static std::string setup_ext4_image(const fs::path& target, const fs::path& image_path);
+
 StorageHandle setup_erofs_storage(const fs::path& mnt_dir, const fs::path& source_dir,
-                                  const fs::path& image_path) {
+                                  const fs::path& image_path, bool deferred_rebuild) {
     LOG_DEBUG("Setting up EROFS storage at " + mnt_dir.string() + " from " + source_dir.string());
 
     if (fs::exists(mnt_dir)) {
@@ -211,6 +515,31 @@ StorageHandle setup_erofs_storage(const fs::path& mnt_dir, const fs::path& sourc
         throw std::runtime_error("mkfs.erofs not found");
     }
 
+    // Deferred mode: a stale image is rebuilt off the critical path while
+    // this boot serves the freshly staged content from the ext4 image
+    if (deferred_rebuild && !erofs_image_fresh(image_path, digest_erofs_source(source_dir))) {
+        try {
+            fs::path ext4_image = image_path.parent_path() / "modules.img";
+            std::string mode = setup_ext4_image(mnt_dir, ext4_image);
+
+            for (const auto& entry : fs::directory_iterator(source_dir)) {
+                if (!sync_dir(entry.path(), mnt_dir / entry.path().filename())) {
+                    throw std::runtime_error("staging copy failed for " +
+                                             entry.path().filename().string());
+                }
+            }
+            finalize_storage_permissions(mnt_dir);
+
+            spawn_deferred_erofs_rebuild(source_dir, image_path);
+            LOG_INFO("EROFS image stale; booted on ext4, rebuilding EROFS in background");
+            return StorageHandle{mnt_dir, mode};
+        } catch (const std::exception& e) {
+            LOG_WARN("Deferred EROFS fallback failed, rebuilding inline: " +
+                     std::string(e.what()));
+            umount2(mnt_dir.c_str(), MNT_DETACH);
+        }
+    }
+
     if (!create_erofs_image(source_dir, image_path)) {
         throw std::runtime_error("Failed to create EROFS image");
     }
@@ -348,19 +677,29 @@ static std::string format_size(uint64_t bytes) {
 
 static uint64_t calculate_dir_size(const fs::path& path) {
     uint64_t total = 0;
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(path)) {
-            if (entry.is_regular_file()) {
-                total += entry.file_size();
-            }
+    // Best-effort: unreadable subtrees are simply not counted
+    walk_directory(path, "", [&](const WalkEntry& e) {
+        if (e.type == DT_REG) {
+            struct stat st;
+            if (fstatat(e.parent_fd, e.name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                total += (uint64_t)st.st_size;
         }
-    } catch (...) {
-        // Ignore errors and return best-effort size
-    }
+        return WalkControl::Recurse;
+    });
     return total;
 }
 
-void print_storage_status() {
+// WebUI polls storage every couple of seconds; a statfs snapshot this old
+// in the shared region is still good enough to answer from
+static constexpr uint64_t LIVE_STATFS_TTL_MS = 2000;
+
+static uint64_t wall_clock_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string export_storage_status_json() {
     auto state = load_runtime_state();
 
     // Daemon PID is registered in kernel, no need for setns
@@ -369,38 +708,57 @@ void print_storage_status() {
     fs::path path =
         state.mount_point.empty() ? fs::path(FALLBACK_CONTENT_DIR) : fs::path(state.mount_point);
 
-    json::Value root = json::Value::object();
-    root["path"] = json::Value(path.string());
-    root["pid"] = json::Value(state.pid);
+    json::Writer w(512);
+    w.begin_object();
+    w.key("path").value(path.string());
+    w.key("pid").value(state.pid);
 
     if (!fs::exists(path)) {
-        root["error"] = json::Value("Not mounted");
-        std::cout << json::dump(root) << "\n";
-        return;
+        w.key("error").value("Not mounted");
+        w.end_object();
+        return w.str();
     }
 
     std::string fs_type = state.storage_mode.empty() ? "unknown" : state.storage_mode;
 
-    struct statfs stats;
-    if (statfs(path.c_str(), &stats) != 0) {
-        root["error"] = json::Value("statvfs failed: " + std::string(strerror(errno)));
-        std::cout << json::dump(root) << "\n";
-        return;
+    // Answer straight from the shared region while its statfs snapshot is
+    // fresh; polling then costs one mmap read instead of any syscalls
+    LiveStatsSnapshot snap;
+    bool have_snap = live_stats_read(snap);
+
+    uint64_t total_bytes = 0;
+    uint64_t free_bytes = 0;
+    uint64_t now_ms = wall_clock_ms();
+    if (have_snap && snap.statfs_total > 0 && now_ms >= snap.statfs_ms &&
+        now_ms - snap.statfs_ms < LIVE_STATFS_TTL_MS) {
+        total_bytes = snap.statfs_total;
+        free_bytes = snap.statfs_free;
+    } else {
+        struct statfs stats;
+        if (statfs(path.c_str(), &stats) != 0) {
+            w.key("error").value("statvfs failed: " + std::string(strerror(errno)));
+            w.end_object();
+            return w.str();
+        }
+        uint64_t block_size = stats.f_bsize;
+        total_bytes = stats.f_blocks * block_size;
+        free_bytes = stats.f_bfree * block_size;
+        live_stats_update_statfs(total_bytes, free_bytes);
     }
 
-    uint64_t block_size = stats.f_bsize;
-    uint64_t total_bytes = stats.f_blocks * block_size;
-    uint64_t free_bytes = stats.f_bfree * block_size;
     uint64_t used_bytes = total_bytes > free_bytes ? total_bytes - free_bytes : 0;
     double percent = total_bytes > 0 ? (used_bytes * 100.0 / total_bytes) : 0.0;
 
-    // Fallback: if used shows 0 but directory has files, compute logical size
-    if (used_bytes == 0 && fs::exists(path)) {
-        uint64_t logical_used = calculate_dir_size(path);
-        if (logical_used > 0) {
-            used_bytes = logical_used;
-            percent = total_bytes > 0 ? (used_bytes * 100.0 / total_bytes) : 0.0;
+    // Fallback: if used shows 0 but modules have content, report the
+    // logical size maintained at sync time; the recursive walk only runs
+    // when no sync has ever populated the region
+    if (used_bytes == 0) {
+        if (have_snap && snap.synced_bytes > 0) {
+            used_bytes = snap.synced_bytes;
+        } else if (fs::exists(path)) {
+            used_bytes = calculate_dir_size(path);
         }
+        percent = total_bytes > 0 ? (used_bytes * 100.0 / total_bytes) : 0.0;
     }
 
     // Mirror/tmpfs mode: data may live in moduledir rather than mount_point
@@ -423,16 +781,21 @@ void print_storage_status() {
 
     // Explicitly check for 0 total bytes which might indicate issue with the mount
     if (total_bytes == 0) {
-        root["warning"] = json::Value("Zero size detected");
+        w.key("warning").value("Zero size detected");
     }
 
-    root["size"] = json::Value(format_size(total_bytes));
-    root["used"] = json::Value(format_size(used_bytes));
-    root["avail"] = json::Value(format_size(free_bytes));
-    root["percent"] = json::Value(percent);
-    root["mode"] = json::Value(fs_type);
+    w.key("size").value(format_size(total_bytes));
+    w.key("used").value(format_size(used_bytes));
+    w.key("avail").value(format_size(free_bytes));
+    w.key("percent").value(percent);
+    w.key("mode").value(fs_type);
+
+    w.end_object();
+    return w.str();
+}
 
-    std::cout << json::dump(root) << "\n";
+void print_storage_status() {
+    std::cout << export_storage_status_json() << "\n";
 }
 
 }  // namespace hymo
\ No newline at end of file
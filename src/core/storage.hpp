@@ -19,15 +19,32 @@ StorageHandle setup_storage(const fs::path& mnt_dir, const fs::path& image_path,
 
 // Build an EROFS image from `source_dir` and mount it read-only at `mnt_dir`.
 // This is intended for mirror flows where content must be synced to a writable
-// staging directory before creating the compressed EROFS image.
+// staging directory before creating the compressed EROFS image. The rebuild is
+// skipped when a digest of the source tree matches the existing image; with
+// `deferred_rebuild`, a stale image is rebuilt in the background while this
+// boot falls back to the ext4 image with the staged content.
 StorageHandle setup_erofs_storage(const fs::path& mnt_dir, const fs::path& source_dir,
-                                  const fs::path& image_path);
+                                  const fs::path& image_path, bool deferred_rebuild = false);
 
-// Exposed for CLI tools
-bool create_image(const fs::path& base_dir);
+// Exposed for CLI tools. The image is fallocate'd in-process and sized
+// from the footprint of `size_from_dir` (headroom added, capped by the
+// image_max_size_mb config option).
+bool create_image(const fs::path& base_dir, const fs::path& size_from_dir = "/data/adb/modules");
+
+// Cap for auto-sized/grown images; wired to image_max_size_mb
+void set_image_size_cap_mb(int mb);
+
+// Grow a mounted ext4 image online (fallocate + resize2fs) when the
+// content about to be synced from `source_dir` would overflow it.
+// No-op for other storage modes.
+void ensure_ext4_capacity(const StorageHandle& storage, const fs::path& image_path,
+                          const fs::path& source_dir);
 
 void finalize_storage_permissions(const fs::path& storage_root);
 
+// Storage usage as a JSON document (shared by CLI and daemon)
+std::string export_storage_status_json();
+
 void print_storage_status();
 
 }  // namespace hymo
\ No newline at end of file
@@ -1,24 +1,364 @@
 // core/sync.cpp - Module content sync
 #include "sync.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <map>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include "../defs.hpp"
 #include "../utils.hpp"
+#include "live_stats.hpp"
+#include "path_index.hpp"
+#include "prefetch.hpp"
+#include "timings.hpp"
 
 namespace hymo {
 
-// Check if module has content for any partition
-static bool has_content(const fs::path& module_path,
-                        const std::vector<std::string>& all_partitions) {
-    for (const auto& partition : all_partitions) {
-        fs::path part_path = module_path / partition;
-        if (has_files_recursive(part_path)) {
-            return true;
+// Content summary file, written next to the sync manifest
+static const char* CONTENT_MANIFEST_NAME = ".hymo_content";
+
+bool ContentManifest::has_mountable(const std::string& partition) const {
+    auto it = partitions.find(partition);
+    if (it == partitions.end())
+        return false;
+    // Mirrors has_files_recursive: only files and symlinks count
+    return it->second.files > 0 || it->second.symlinks > 0;
+}
+
+bool load_content_manifest(const fs::path& module_dir, ContentManifest& out) {
+    std::ifstream in(module_dir / CONTENT_MANIFEST_NAME);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        PartitionContent pc;
+        char name_buf[256];
+        // Partition name is last so the counts parse unambiguously
+        if (sscanf(line.c_str(), "%lu %lu %lu %lu %llu %255[^\n]", &pc.files, &pc.dirs,
+                   &pc.symlinks, &pc.nodes, &pc.bytes, name_buf) == 6) {
+            out.partitions[name_buf] = pc;
+        } else if (sscanf(line.c_str(), "%lu %lu %lu %lu %255[^\n]", &pc.files, &pc.dirs,
+                          &pc.symlinks, &pc.nodes, name_buf) == 5) {
+            // Pre-bytes format; counts still valid, size unknown
+            pc.bytes = 0;
+            out.partitions[name_buf] = pc;
+        }
+    }
+    return true;
+}
+
+static bool write_content_manifest(const fs::path& file, const ContentManifest& manifest) {
+    std::ofstream outf(file, std::ios::trunc);
+    if (!outf.is_open())
+        return false;
+
+    for (const auto& [name, pc] : manifest.partitions) {
+        outf << pc.files << " " << pc.dirs << " " << pc.symlinks << " " << pc.nodes << " "
+             << pc.bytes << " " << name << "\n";
+    }
+    return outf.good();
+}
+
+bool module_has_content(const fs::path& module_dir,
+                        const std::vector<std::string>& partitions) {
+    ContentManifest manifest;
+    if (load_content_manifest(module_dir, manifest)) {
+        for (const auto& partition : partitions) {
+            if (manifest.has_mountable(partition))
+                return true;
         }
+        return false;
+    }
+
+    // Never-synced tree (e.g. the live module dir): fall back to walking
+    for (const auto& partition : partitions) {
+        if (has_files_recursive(module_dir / partition))
+            return true;
     }
     return false;
 }
 
+// Per-file sync manifest, written next to the copied content. Records the
+// source tree's lstat signature at sync time so the next boot can copy only
+// what actually changed instead of recopying the whole module.
+static const char* SYNC_MANIFEST_NAME = ".hymo_sync_manifest";
+
+struct ManifestEntry {
+    char type = '?';  // f/d/l/c/b/p/s
+    unsigned long long size = 0;
+    long long mtime_sec = 0;
+    long mtime_nsec = 0;
+    long long ctime_sec = 0;  // catches chmod/chcon which keep mtime intact
+    long ctime_nsec = 0;
+    unsigned int mode = 0;
+    unsigned long long rdev = 0;
+};
+
+static char mode_to_type(mode_t mode) {
+    switch (mode & S_IFMT) {
+    case S_IFREG:
+        return 'f';
+    case S_IFDIR:
+        return 'd';
+    case S_IFLNK:
+        return 'l';
+    case S_IFCHR:
+        return 'c';
+    case S_IFBLK:
+        return 'b';
+    case S_IFIFO:
+        return 'p';
+    case S_IFSOCK:
+        return 's';
+    default:
+        return '?';
+    }
+}
+
+static ManifestEntry entry_from_stat(const struct stat& st) {
+    ManifestEntry e;
+    e.type = mode_to_type(st.st_mode);
+    e.size = st.st_size;
+    e.mtime_sec = st.st_mtim.tv_sec;
+    e.mtime_nsec = st.st_mtim.tv_nsec;
+    e.ctime_sec = st.st_ctim.tv_sec;
+    e.ctime_nsec = st.st_ctim.tv_nsec;
+    e.mode = st.st_mode;
+    e.rdev = st.st_rdev;
+    return e;
+}
+
+// Walk the source tree collecting an lstat signature per entry
+static void build_source_manifest(const fs::path& dir, const std::string& rel_prefix,
+                                  std::map<std::string, ManifestEntry>& out) {
+    try {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            std::string rel =
+                rel_prefix.empty() ? entry.path().filename().string()
+                                   : rel_prefix + "/" + entry.path().filename().string();
+
+            struct stat st;
+            if (lstat(entry.path().c_str(), &st) != 0)
+                continue;
+
+            out[rel] = entry_from_stat(st);
+
+            if (S_ISDIR(st.st_mode))
+                build_source_manifest(entry.path(), rel, out);
+        }
+    } catch (const std::exception& e) {
+        LOG_WARN("Manifest scan failed for " + dir.string() + ": " + std::string(e.what()));
+    }
+}
+
+// Fold the per-file sync manifest into per-partition counts; top-level
+// directories are the partitions themselves
+static ContentManifest summarize_manifest(const std::map<std::string, ManifestEntry>& manifest) {
+    ContentManifest out;
+    for (const auto& [rel, e] : manifest) {
+        auto slash = rel.find('/');
+        if (slash == std::string::npos) {
+            if (e.type == 'd')
+                out.partitions[rel];  // present even when empty
+            continue;
+        }
+
+        PartitionContent& pc = out.partitions[rel.substr(0, slash)];
+        switch (e.type) {
+        case 'f':
+            pc.files++;
+            pc.bytes += e.size;
+            break;
+        case 'd':
+            pc.dirs++;
+            break;
+        case 'l':
+            pc.symlinks++;
+            break;
+        case 'c':
+        case 'b':
+            pc.nodes++;
+            break;
+        default:
+            break;
+        }
+    }
+    return out;
+}
+
+static bool load_manifest(const fs::path& file, std::map<std::string, ManifestEntry>& out) {
+    std::ifstream in(file);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        ManifestEntry e;
+        char rel_buf[4096];
+        // Relative path is last so it may contain spaces
+        if (sscanf(line.c_str(), "%c %llu %lld.%ld %lld.%ld %o %llu %4095[^\n]", &e.type, &e.size,
+                   &e.mtime_sec, &e.mtime_nsec, &e.ctime_sec, &e.ctime_nsec, &e.mode, &e.rdev,
+                   rel_buf) == 9) {
+            out[rel_buf] = e;
+        }
+    }
+    return true;
+}
+
+fs::path sync_manifest_path(const fs::path& module_dir) {
+    return module_dir / SYNC_MANIFEST_NAME;
+}
+
+bool for_each_manifest_path(const fs::path& module_dir,
+                            const std::function<void(const std::string& rel, char type)>& sink) {
+    std::ifstream in(module_dir / SYNC_MANIFEST_NAME);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        ManifestEntry e;
+        char rel_buf[4096];
+        if (sscanf(line.c_str(), "%c %llu %lld.%ld %lld.%ld %o %llu %4095[^\n]", &e.type, &e.size,
+                   &e.mtime_sec, &e.mtime_nsec, &e.ctime_sec, &e.ctime_nsec, &e.mode, &e.rdev,
+                   rel_buf) == 9) {
+            sink(rel_buf, e.type);
+        }
+    }
+    return true;
+}
+
+static bool write_manifest(const fs::path& file,
+                           const std::map<std::string, ManifestEntry>& manifest) {
+    std::ofstream outf(file, std::ios::trunc);
+    if (!outf.is_open())
+        return false;
+
+    char buf[256];
+    for (const auto& [rel, e] : manifest) {
+        snprintf(buf, sizeof(buf), "%c %llu %lld.%ld %lld.%ld %o %llu ", e.type, e.size,
+                 e.mtime_sec, e.mtime_nsec, e.ctime_sec, e.ctime_nsec, e.mode, e.rdev);
+        outf << buf << rel << "\n";
+    }
+    return outf.good();
+}
+
+static bool manifest_entry_changed(const ManifestEntry& old_e, const ManifestEntry& new_e) {
+    if (old_e.type != new_e.type)
+        return true;
+    // Directory content changes show up on the children themselves
+    if (new_e.type == 'd')
+        return old_e.mode != new_e.mode || old_e.ctime_sec != new_e.ctime_sec ||
+               old_e.ctime_nsec != new_e.ctime_nsec;
+    return old_e.size != new_e.size || old_e.mtime_sec != new_e.mtime_sec ||
+           old_e.mtime_nsec != new_e.mtime_nsec || old_e.ctime_sec != new_e.ctime_sec ||
+           old_e.ctime_nsec != new_e.ctime_nsec || old_e.mode != new_e.mode ||
+           old_e.rdev != new_e.rdev;
+}
+
+// Copy one changed entry, mirroring native_cp_r's per-type handling
+static bool copy_manifest_entry(const fs::path& src, const fs::path& dst,
+                                const ManifestEntry& e) {
+    try {
+        fs::create_directories(dst.parent_path());
+
+        switch (e.type) {
+        case 'd':
+            if (!fs::is_directory(dst)) {
+                if (fs::exists(dst))
+                    fs::remove_all(dst);
+                fs::create_directories(dst);
+            }
+            fs::permissions(dst, fs::status(src).permissions());
+            break;
+        case 'l': {
+            auto link_target = fs::read_symlink(src);
+            if (fs::exists(fs::symlink_status(dst)))
+                fs::remove_all(dst);
+            fs::create_symlink(link_target, dst);
+            break;
+        }
+        case 'f':
+            if (fs::is_directory(dst))
+                fs::remove_all(dst);
+            if (!copy_file_fast(src, dst)) {
+                fs::copy_file(src, dst, fs::copy_options::overwrite_existing);
+            }
+            fs::permissions(dst, fs::status(src).permissions());
+            break;
+        case 'c':
+        case 'b':
+            if (fs::exists(fs::symlink_status(dst)))
+                fs::remove_all(dst);
+            if (mknod(dst.c_str(), e.mode, e.rdev) != 0) {
+                LOG_WARN("mknod failed for " + dst.string());
+                return false;
+            }
+            break;
+        default:
+            LOG_DEBUG("Skipping special file: " + src.string());
+            return true;
+        }
+
+        lsetfilecon(dst, get_context_for_path(dst));
+        return true;
+    } catch (const std::exception& ex) {
+        LOG_WARN("Incremental copy failed (" + src.string() + "): " + std::string(ex.what()));
+        return false;
+    }
+}
+
+// Repair the SELinux context of one synced path from its system counterpart
+static void repair_entry_context(const fs::path& module_root, const std::string& rel) {
+    fs::path system_path = fs::path("/") / rel;
+    if (fs::exists(system_path)) {
+        copy_path_context(system_path, module_root / rel);
+    }
+}
+
+// Apply only the delta between the recorded manifest and the current source
+// tree. Returns false if anything went wrong; caller falls back to full copy.
+static bool incremental_sync(const fs::path& src_root, const fs::path& dst_root,
+                             const std::map<std::string, ManifestEntry>& previous,
+                             const std::map<std::string, ManifestEntry>& current) {
+    size_t copied = 0;
+    size_t removed = 0;
+
+    for (const auto& [rel, cur] : current) {
+        auto old_it = previous.find(rel);
+        if (old_it != previous.end() && !manifest_entry_changed(old_it->second, cur))
+            continue;
+
+        if (!copy_manifest_entry(src_root / rel, dst_root / rel, cur))
+            return false;
+        repair_entry_context(dst_root, rel);
+        copied++;
+    }
+
+    // Reverse order removes children before their parents
+    for (auto it = previous.rbegin(); it != previous.rend(); ++it) {
+        if (current.find(it->first) != current.end())
+            continue;
+        try {
+            fs::remove_all(dst_root / it->first);
+            removed++;
+        } catch (const std::exception& e) {
+            LOG_WARN("Failed to remove stale entry: " + it->first);
+            return false;
+        }
+    }
+
+    LOG_INFO("Incremental sync: " + std::to_string(copied) + " copied, " +
+             std::to_string(removed) + " removed");
+    return true;
+}
+
 // Check if module needs sync by comparing module.prop
 static bool should_sync(const fs::path& src, const fs::path& dst) {
     if (!fs::exists(dst)) {
@@ -81,63 +421,223 @@ static void prune_orphaned_modules(const std::vector<Module>& modules,
     }
 }
 
-// Map SELinux context from system if possible
-static void recursive_context_repair(const fs::path& base, const fs::path& current) {
-    if (!fs::exists(current)) {
-        return;
-    }
+// ---- Batch SELinux context repair ----
+//
+// The old recursive repair paid one lgetxattr + lsetxattr round-trip
+// per entry, serially — for big modules the second-largest sync cost
+// after the copy. The batch engine collects every synced entry first,
+// snapshots the reference partition's contexts into a table with a
+// small worker pool, then applies them from the same pool. Entries the
+// table could not answer fall back to the per-file lookup.
+
+struct ContextJob {
+    fs::path dst;
+    fs::path ref;           // same path under the real partition
+    bool overlay_internal;  // upperdir/workdir: inherit the parent context
+};
 
+static void collect_context_jobs(const fs::path& base, const fs::path& current,
+                                 std::vector<ContextJob>& jobs) {
     try {
         std::string file_name = current.filename().string();
+        bool internal = file_name == "upperdir" || file_name == "workdir";
+        jobs.push_back({current, fs::path("/") / fs::relative(current, base), internal});
 
-        // Use parent context for internal overlay structs
-        if (file_name == "upperdir" || file_name == "workdir") {
-            if (current.has_parent_path()) {
-                fs::path parent = current.parent_path();
-                try {
-                    std::string parent_ctx = lgetfilecon(parent);
-                    lsetfilecon(current, parent_ctx);
-                } catch (...) {
-                }
-            }
-        } else {
-            fs::path relative = fs::relative(current, base);
-            fs::path system_path = fs::path("/") / relative;
-
-            if (fs::exists(system_path)) {
-                copy_path_context(system_path, current);
-            }
-        }
-
-        if (fs::is_directory(current)) {
+        if (fs::is_directory(current) && !fs::is_symlink(current)) {
             for (const auto& entry : fs::directory_iterator(current)) {
-                recursive_context_repair(base, entry.path());
+                collect_context_jobs(base, entry.path(), jobs);
             }
         }
     } catch (const std::exception& e) {
-        LOG_DEBUG("Context repair failed: " + current.string());
+        LOG_DEBUG("Context scan failed: " + current.string());
     }
 }
 
+// Run fn(i) for every job index on a small pool. Sized conservatively:
+// sync already parallelizes across modules, so this only smooths out
+// the xattr syscall latency within one large module.
+static void for_each_job_parallel(size_t job_count, const std::function<void(size_t)>& fn) {
+    size_t workers = std::min((size_t)4, (size_t)std::thread::hardware_concurrency());
+    if (workers <= 1 || job_count < 64) {
+        for (size_t i = 0; i < job_count; i++)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; w++) {
+        pool.emplace_back([&]() {
+            while (true) {
+                size_t i = next.fetch_add(1);
+                if (i >= job_count)
+                    break;
+                fn(i);
+            }
+        });
+    }
+    for (auto& worker : pool)
+        worker.join();
+}
+
 static void repair_module_contexts(const fs::path& module_root, const std::string& module_id,
                                    const std::vector<std::string>& all_partitions) {
     LOG_DEBUG("Repairing SELinux contexts for: " + module_id);
 
+    std::vector<ContextJob> jobs;
     for (const auto& partition : all_partitions) {
         fs::path part_root = module_root / partition;
-
         if (fs::exists(part_root) && fs::is_directory(part_root)) {
+            collect_context_jobs(module_root, part_root, jobs);
+        }
+    }
+    if (jobs.empty())
+        return;
+
+    // Phase 1: reference context table, one lookup per path
+    std::vector<std::string> contexts(jobs.size());
+    for_each_job_parallel(jobs.size(), [&](size_t i) {
+        if (jobs[i].overlay_internal)
+            return;
+        if (fs::exists(jobs[i].ref)) {
+            contexts[i] = lgetfilecon(jobs[i].ref);
+        }
+    });
+
+    // Parent lookups for internal jobs resolve against the phase-1 table:
+    // re-reading the parent from disk here would race with the worker
+    // relabeling that same parent and copy its stale pre-repair context
+    std::unordered_map<std::string, size_t> dst_index;
+    dst_index.reserve(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (!jobs[i].overlay_internal)
+            dst_index.emplace(jobs[i].dst.string(), i);
+    }
+
+    // Phase 2: apply
+    for_each_job_parallel(jobs.size(), [&](size_t i) {
+        const ContextJob& job = jobs[i];
+        if (job.overlay_internal) {
+            // Internal overlay structs take their parent's context
+            if (!job.dst.has_parent_path())
+                return;
+            fs::path parent = job.dst.parent_path();
+            auto it = dst_index.find(parent.string());
+            if (it != dst_index.end() && !contexts[it->second].empty()) {
+                std::string ctx = contexts[it->second];
+                if (ctx.find("u:object_r:rootfs:s0") != std::string::npos) {
+                    ctx = get_context_for_path(jobs[it->second].dst);
+                }
+                lsetfilecon(job.dst, ctx);
+            } else {
+                // Parent not in the table means no worker relabels it,
+                // so reading it from disk cannot race
+                lsetfilecon(job.dst, lgetfilecon(parent));
+            }
+            return;
+        }
+
+        if (!contexts[i].empty()) {
+            std::string ctx = contexts[i];
+            // Fix rootfs context (mirrors copy_path_context)
+            if (ctx.find("u:object_r:rootfs:s0") != std::string::npos) {
+                ctx = get_context_for_path(job.dst);
+            }
+            lsetfilecon(job.dst, ctx);
+        } else if (fs::exists(job.ref)) {
+            // Raced with the table scan; per-file lookup as before
+            copy_path_context(job.ref, job.dst);
+        }
+    });
+}
+
+// Full sync job for one module: clean, copy, repair contexts.
+// Modules touch disjoint destination trees, so jobs are independent.
+static void sync_one_module(const Module& module, const fs::path& storage_root,
+                            const std::vector<std::string>& all_partitions) {
+    fs::path dst = storage_root / module.id;
+
+    // Fast path: unchanged module with a content summary from the last
+    // sync — no directory walk at all
+    bool up_to_date = !should_sync(module.source_path, dst);
+    if (up_to_date && fs::exists(dst / CONTENT_MANIFEST_NAME)) {
+        LOG_DEBUG("Up-to-date: " + module.id);
+        return;
+    }
+
+    // One walk yields both the incremental-sync signature and the
+    // content summary; the old separate has-content scan is gone
+    std::map<std::string, ManifestEntry> current;
+    build_source_manifest(module.source_path, "", current);
+    ContentManifest content = summarize_manifest(current);
+
+    bool mountable = false;
+    for (const auto& partition : all_partitions) {
+        if (content.has_mountable(partition)) {
+            mountable = true;
+            break;
+        }
+    }
+    if (!mountable) {
+        LOG_DEBUG("Skipping empty module: " + module.id);
+        return;
+    }
+
+    if (up_to_date) {
+        // Storage predates the content summary; backfill it so the next
+        // boot takes the fast path
+        if (!write_content_manifest(dst / CONTENT_MANIFEST_NAME, content)) {
+            LOG_WARN("Failed to write content manifest for " + module.id);
+        }
+        LOG_DEBUG("Up-to-date: " + module.id);
+        return;
+    }
+
+    LOG_DEBUG("Syncing: " + module.id);
+
+    // Prefer the incremental path when a manifest from the previous
+    // sync exists; a version bump then costs only the files that
+    // actually changed instead of a full recopy.
+    bool synced = false;
+    std::map<std::string, ManifestEntry> previous;
+    if (fs::exists(dst) && load_manifest(dst / SYNC_MANIFEST_NAME, previous) &&
+        !previous.empty()) {
+        LOG_DEBUG("Incremental sync: " + module.id);
+        synced = incremental_sync(module.source_path, dst, previous, current);
+        if (!synced) {
+            LOG_WARN("Incremental sync failed for " + module.id +
+                     ", falling back to full copy");
+        }
+    }
+
+    if (!synced) {
+        if (fs::exists(dst)) {
             try {
-                recursive_context_repair(module_root, part_root);
+                fs::remove_all(dst);
             } catch (const std::exception& e) {
-                LOG_WARN("Context repair failed for " + module_id + "/" + partition);
+                LOG_WARN("Failed to clean " + module.id);
             }
         }
+
+        if (!sync_dir(module.source_path, dst)) {
+            LOG_ERROR("Failed to sync: " + module.id);
+            return;
+        }
+        repair_module_contexts(dst, module.id, all_partitions);
+    }
+
+    if (!write_manifest(dst / SYNC_MANIFEST_NAME, current)) {
+        LOG_WARN("Failed to write sync manifest for " + module.id);
+    }
+    if (!write_content_manifest(dst / CONTENT_MANIFEST_NAME, content)) {
+        LOG_WARN("Failed to write content manifest for " + module.id);
     }
 }
 
 void perform_sync(const std::vector<Module>& modules, const fs::path& storage_root,
                   const Config& config) {
+    ScopedTimer timer("sync");
     LOG_INFO("Syncing modules to " + storage_root.string());
 
     std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
@@ -145,38 +645,90 @@ void perform_sync(const std::vector<Module>& modules, const fs::path& storage_ro
         all_partitions.push_back(part);
     }
 
+    // Pruning mutates shared storage layout, keep it serial before the pool
     prune_orphaned_modules(modules, storage_root);
 
+    // Profile-guided ordering: modules whose files survived the most
+    // boots sync first, so the most user-visible content is ready
+    // earliest. Pure scheduling — overlay precedence still comes from
+    // the module list order.
+    std::vector<const Module*> ordered;
+    ordered.reserve(modules.size());
     for (const auto& module : modules) {
-        fs::path dst = storage_root / module.id;
+        ordered.push_back(&module);
+    }
+    std::map<std::string, int> priorities = load_module_priorities();
+    if (!priorities.empty()) {
+        auto score = [&priorities](const Module* m) {
+            auto it = priorities.find(m->id);
+            return it != priorities.end() ? it->second : 0;
+        };
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [&score](const Module* a, const Module* b) {
+                             return score(a) > score(b);
+                         });
+    }
 
-        if (!has_content(module.source_path, all_partitions)) {
-            LOG_DEBUG("Skipping empty module: " + module.id);
-            continue;
-        }
+    size_t workers = config.sync_threads > 0 ? (size_t)config.sync_threads
+                                             : (size_t)std::thread::hardware_concurrency();
+    if (workers == 0)
+        workers = 1;
+    workers = std::min(workers, modules.size());
 
-        if (should_sync(module.source_path, dst)) {
-            LOG_DEBUG("Syncing: " + module.id);
+    if (workers <= 1) {
+        for (const Module* module : ordered) {
+            sync_one_module(*module, storage_root, all_partitions);
+        }
+    } else {
+        LOG_INFO("Parallel sync with " + std::to_string(workers) + " workers");
 
-            if (fs::exists(dst)) {
-                try {
-                    fs::remove_all(dst);
-                } catch (const std::exception& e) {
-                    LOG_WARN("Failed to clean " + module.id);
+        std::atomic<size_t> next_index{0};
+        std::vector<std::thread> pool;
+        pool.reserve(workers);
+        for (size_t i = 0; i < workers; i++) {
+            pool.emplace_back([&]() {
+                while (true) {
+                    size_t idx = next_index.fetch_add(1);
+                    if (idx >= ordered.size())
+                        break;
+                    sync_one_module(*ordered[idx], storage_root, all_partitions);
                 }
-            }
+            });
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+    }
 
-            if (!sync_dir(module.source_path, dst)) {
-                LOG_ERROR("Failed to sync: " + module.id);
-            } else {
-                repair_module_contexts(dst, module.id, all_partitions);
-            }
-        } else {
-            LOG_DEBUG("Up-to-date: " + module.id);
+    // Manifests are warm in the page cache right now; refresh the
+    // inverted path index from them for conflict queries
+    update_path_index(config, modules, storage_root);
+
+    // Publish the logical content size to the shared live-stats region so
+    // storage queries never have to walk the tree themselves
+    uint64_t synced_bytes = 0;
+    uint32_t counted = 0;
+    for (const auto& module : modules) {
+        ContentManifest manifest;
+        if (!load_content_manifest(storage_root / module.id, manifest))
+            continue;
+        for (const auto& [name, pc] : manifest.partitions) {
+            (void)name;
+            synced_bytes += pc.bytes;
         }
+        counted++;
     }
+    live_stats_update_sync(synced_bytes, counted);
 
     LOG_INFO("Sync completed.");
 }
 
+void sync_module(const Module& module, const fs::path& storage_root, const Config& config) {
+    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
+    for (const auto& part : config.partitions) {
+        all_partitions.push_back(part);
+    }
+    sync_one_module(module, storage_root, all_partitions);
+}
+
 }  // namespace hymo
\ No newline at end of file
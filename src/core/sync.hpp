@@ -4,12 +4,56 @@
 #include "../conf/config.hpp"
 #include "inventory.hpp"
 #include <filesystem>
+#include <functional>
+#include <map>
 
 namespace fs = std::filesystem;
 
 namespace hymo {
 
+// Per-partition entry counts recorded at sync time
+struct PartitionContent {
+  unsigned long files = 0;
+  unsigned long dirs = 0;
+  unsigned long symlinks = 0;
+  unsigned long nodes = 0; // char/block devices, including whiteouts
+  unsigned long long bytes = 0; // logical size of regular files
+};
+
+// Compact content summary written into each synced module's storage
+// directory, so "does this module ship anything for partition X" reads
+// one small file instead of re-walking the tree
+struct ContentManifest {
+  std::map<std::string, PartitionContent> partitions;
+
+  // True when the partition carries entries magic/overlay would mount
+  bool has_mountable(const std::string &partition) const;
+};
+
+bool load_content_manifest(const fs::path &module_dir, ContentManifest &out);
+
+// Location of a synced module's per-file manifest (for mtime/size
+// signature checks without parsing it)
+fs::path sync_manifest_path(const fs::path &module_dir);
+
+// Stream the relative paths recorded in a module's sync manifest with
+// their type chars; false when the manifest is missing
+bool for_each_manifest_path(
+    const fs::path &module_dir,
+    const std::function<void(const std::string &rel, char type)> &sink);
+
+// Manifest fast path with a recursive-walk fallback for directories that
+// were never synced (e.g. the live module source tree)
+bool module_has_content(const fs::path &module_dir,
+                        const std::vector<std::string> &partitions);
+
 void perform_sync(const std::vector<Module> &modules,
                   const fs::path &storage_root, const Config &config);
 
+// Targeted single-module sync (used by watch mode); takes the same
+// incremental route as perform_sync but skips pruning and the path
+// index refresh
+void sync_module(const Module &module, const fs::path &storage_root,
+                 const Config &config);
+
 } // namespace hymo
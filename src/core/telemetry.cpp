@@ -0,0 +1,165 @@
+// core/telemetry.cpp - Cross-boot performance telemetry ring implementation
+#include "telemetry.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "../defs.hpp"
+#include "../utils.hpp"
+#include "json_writer.hpp"
+
+namespace hymo {
+
+// ---- Ring file format ----
+//
+// A fixed header followed by TELEMETRY_CAPACITY fixed-size slots,
+// written round-robin. next_slot points at the slot the next boot will
+// overwrite; count saturates at the capacity. Readers take the newest
+// `count` slots walking backwards from next_slot.
+
+static constexpr uint32_t TELEMETRY_MAGIC = 0x4C545948;  // "HYTL"
+static constexpr uint32_t TELEMETRY_VERSION = 1;
+static constexpr uint32_t TELEMETRY_CAPACITY = 64;
+
+static const char* TELEMETRY_FILE_NAME = "telemetry.ring";
+
+struct TelemetryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t next_slot;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct TelemetrySlot {
+    uint64_t boot_ts;
+    uint32_t sync_ms;
+    uint32_t plan_ms;
+    uint32_t rules_ms;
+    uint32_t exec_ms;
+    uint32_t magic_ms;
+    uint32_t module_count;
+    uint32_t rule_count;
+    uint32_t fallback_count;
+    char storage_mode[8];  // NUL-padded short string ("tmpfs", "ext4", ...)
+};
+
+static size_t s_rule_count = 0;
+
+void telemetry_note_rule_count(size_t count) {
+    s_rule_count = count;
+}
+
+size_t telemetry_rule_count() {
+    return s_rule_count;
+}
+
+static fs::path telemetry_file() {
+    return fs::path(RUN_DIR) / TELEMETRY_FILE_NAME;
+}
+
+static off_t slot_offset(uint32_t slot) {
+    return (off_t)(sizeof(TelemetryHeader) + (size_t)slot * sizeof(TelemetrySlot));
+}
+
+bool record_boot_telemetry(const BootTelemetry& t) {
+    ensure_dir_exists(RUN_DIR);
+
+    int fd = open(telemetry_file().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_WARN("Telemetry: cannot open ring: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    TelemetryHeader header;
+    ssize_t n = pread(fd, &header, sizeof(header), 0);
+    if (n != (ssize_t)sizeof(header) || header.magic != TELEMETRY_MAGIC ||
+        header.version != TELEMETRY_VERSION || header.capacity != TELEMETRY_CAPACITY ||
+        header.next_slot >= header.capacity || header.count > header.capacity) {
+        // Fresh file or a layout change: start the ring over
+        memset(&header, 0, sizeof(header));
+        header.magic = TELEMETRY_MAGIC;
+        header.version = TELEMETRY_VERSION;
+        header.capacity = TELEMETRY_CAPACITY;
+    }
+
+    TelemetrySlot slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.boot_ts = t.boot_ts;
+    slot.sync_ms = t.sync_ms;
+    slot.plan_ms = t.plan_ms;
+    slot.rules_ms = t.rules_ms;
+    slot.exec_ms = t.exec_ms;
+    slot.magic_ms = t.magic_ms;
+    slot.module_count = t.module_count;
+    slot.rule_count = t.rule_count;
+    slot.fallback_count = t.fallback_count;
+    strncpy(slot.storage_mode, t.storage_mode.c_str(), sizeof(slot.storage_mode) - 1);
+
+    uint32_t target = header.next_slot;
+    header.next_slot = (header.next_slot + 1) % header.capacity;
+    if (header.count < header.capacity)
+        header.count++;
+
+    bool ok = pwrite(fd, &slot, sizeof(slot), slot_offset(target)) == (ssize_t)sizeof(slot) &&
+              pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+    close(fd);
+
+    if (!ok)
+        LOG_WARN("Telemetry: ring write failed: " + std::string(strerror(errno)));
+    return ok;
+}
+
+std::string export_telemetry_history_json(size_t max_boots) {
+    json::Writer w(4096);
+    w.begin_array();
+
+    int fd = open(telemetry_file().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        w.end_array();
+        return w.str();
+    }
+
+    TelemetryHeader header;
+    ssize_t n = pread(fd, &header, sizeof(header), 0);
+    if (n != (ssize_t)sizeof(header) || header.magic != TELEMETRY_MAGIC ||
+        header.version != TELEMETRY_VERSION || header.capacity == 0 ||
+        header.next_slot >= header.capacity || header.count > header.capacity) {
+        close(fd);
+        w.end_array();
+        return w.str();
+    }
+
+    size_t emit = header.count < max_boots ? header.count : max_boots;
+    for (size_t i = 0; i < emit; i++) {
+        // Newest first: walk backwards from the slot written last
+        uint32_t slot_idx =
+            (header.next_slot + header.capacity - 1 - (uint32_t)i) % header.capacity;
+
+        TelemetrySlot slot;
+        if (pread(fd, &slot, sizeof(slot), slot_offset(slot_idx)) != (ssize_t)sizeof(slot))
+            break;
+        slot.storage_mode[sizeof(slot.storage_mode) - 1] = '\0';
+
+        w.begin_object();
+        w.key("boot_ts").value((unsigned long long)slot.boot_ts);
+        w.key("sync_ms").value(slot.sync_ms);
+        w.key("plan_ms").value(slot.plan_ms);
+        w.key("rules_ms").value(slot.rules_ms);
+        w.key("exec_ms").value(slot.exec_ms);
+        w.key("magic_ms").value(slot.magic_ms);
+        w.key("modules").value(slot.module_count);
+        w.key("rules").value(slot.rule_count);
+        w.key("fallbacks").value(slot.fallback_count);
+        w.key("storage_mode").value(slot.storage_mode);
+        w.end_object();
+    }
+    close(fd);
+
+    w.end_array();
+    return w.str();
+}
+
+}  // namespace hymo
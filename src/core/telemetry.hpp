@@ -0,0 +1,40 @@
+// core/telemetry.hpp - Cross-boot performance telemetry ring
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hymo {
+
+// One boot's worth of pipeline metrics, appended to the ring at the end
+// of do_mount. Durations are whole milliseconds; the per-phase split
+// follows the ScopedTimer phase names.
+struct BootTelemetry {
+    uint64_t boot_ts = 0;  // epoch seconds when the record was written
+    uint32_t sync_ms = 0;
+    uint32_t plan_ms = 0;   // generate_plan + hymofs_emit
+    uint32_t rules_ms = 0;  // hymofs_apply
+    uint32_t exec_ms = 0;   // execute_plan (includes overlay workers)
+    uint32_t magic_ms = 0;
+    uint32_t module_count = 0;
+    uint32_t rule_count = 0;
+    uint32_t fallback_count = 0;
+    std::string storage_mode;
+};
+
+// Append one record to run/telemetry.ring. The file holds a fixed
+// number of slots, so size is bounded and a boot costs two small
+// pwrites (slot + header).
+bool record_boot_telemetry(const BootTelemetry& t);
+
+// Stash the HymoFS rule count for the record written later this boot;
+// called from apply_hymofs_rules, which is the only place that sees the
+// full rule set
+void telemetry_note_rule_count(size_t count);
+size_t telemetry_rule_count();
+
+// The last `max_boots` records, newest first, as a JSON array
+std::string export_telemetry_history_json(size_t max_boots = 32);
+
+}  // namespace hymo
@@ -0,0 +1,134 @@
+// core/timings.cpp - Mount pipeline phase timing implementation
+#include "timings.hpp"
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include "../defs.hpp"
+#include "../utils.hpp"
+#include "json.hpp"
+
+namespace hymo {
+
+// Power-of-two millisecond buckets: <1ms, <2ms, ... <1024ms, rest
+static constexpr int HISTOGRAM_BUCKETS = 12;
+
+struct PhaseStat {
+    uint64_t count = 0;
+    double total_ms = 0.0;
+    double min_ms = 0.0;
+    double max_ms = 0.0;
+    uint64_t histogram[HISTOGRAM_BUCKETS] = {};
+};
+
+static std::mutex s_timings_mutex;
+static std::map<std::string, PhaseStat> s_timings;
+
+static const char* TIMINGS_FILE_NAME = "timings.json";
+
+static int bucket_for(double ms) {
+    double bound = 1.0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+        if (ms < bound) {
+            return i;
+        }
+        bound *= 2.0;
+    }
+    return HISTOGRAM_BUCKETS - 1;
+}
+
+ScopedTimer::ScopedTimer(std::string phase)
+    : phase_(std::move(phase)), start_(std::chrono::steady_clock::now()) {}
+
+ScopedTimer::~ScopedTimer() {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    record_phase_duration(phase_, ms);
+}
+
+void record_phase_duration(const std::string& phase, double ms) {
+    std::lock_guard<std::mutex> lock(s_timings_mutex);
+    PhaseStat& stat = s_timings[phase];
+    if (stat.count == 0 || ms < stat.min_ms) {
+        stat.min_ms = ms;
+    }
+    if (ms > stat.max_ms) {
+        stat.max_ms = ms;
+    }
+    stat.count++;
+    stat.total_ms += ms;
+    stat.histogram[bucket_for(ms)]++;
+}
+
+double phase_total_ms(const std::string& phase) {
+    std::lock_guard<std::mutex> lock(s_timings_mutex);
+    auto it = s_timings.find(phase);
+    return it == s_timings.end() ? 0.0 : it->second.total_ms;
+}
+
+static std::string dump_timings_locked() {
+    json::Value phases = json::Value::object();
+    for (const auto& [name, stat] : s_timings) {
+        json::Value p = json::Value::object();
+        p["count"] = json::Value((int)stat.count);
+        p["total_ms"] = json::Value(stat.total_ms);
+        p["min_ms"] = json::Value(stat.min_ms);
+        p["max_ms"] = json::Value(stat.max_ms);
+
+        json::Value buckets = json::Value::array();
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            buckets.push_back(json::Value((int)stat.histogram[i]));
+        }
+        p["histogram"] = buckets;
+        phases[name] = p;
+    }
+
+    json::Value root = json::Value::object();
+    // Bucket i counts samples below 2^i ms; the last bucket is open-ended
+    root["histogram_bucket_ms"] = json::Value("pow2");
+    root["phases"] = phases;
+    return json::dump(root, 2);
+}
+
+bool save_phase_timings() {
+    std::string doc;
+    {
+        std::lock_guard<std::mutex> lock(s_timings_mutex);
+        if (s_timings.empty()) {
+            return true;
+        }
+        doc = dump_timings_locked();
+    }
+
+    ensure_dir_exists(RUN_DIR);
+    std::ofstream file(fs::path(RUN_DIR) / TIMINGS_FILE_NAME);
+    if (!file.is_open()) {
+        LOG_WARN("Failed to save phase timings");
+        return false;
+    }
+    file << doc << "\n";
+    return true;
+}
+
+std::string export_timings_json() {
+    {
+        std::lock_guard<std::mutex> lock(s_timings_mutex);
+        if (!s_timings.empty()) {
+            return dump_timings_locked();
+        }
+    }
+
+    std::ifstream file(fs::path(RUN_DIR) / TIMINGS_FILE_NAME);
+    if (!file.is_open()) {
+        return "{}";
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string doc = buffer.str();
+    while (!doc.empty() && (doc.back() == '\n' || doc.back() == '\r')) {
+        doc.pop_back();
+    }
+    return doc.empty() ? "{}" : doc;
+}
+
+}  // namespace hymo
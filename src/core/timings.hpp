@@ -0,0 +1,39 @@
+// core/timings.hpp - Mount pipeline phase timing
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace hymo {
+
+// Times one pipeline phase from construction to destruction and folds
+// the duration into the process-wide aggregate for that phase name.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(std::string phase);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    std::string phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Fold one sample (milliseconds) into the aggregate for `phase`
+void record_phase_duration(const std::string& phase, double ms);
+
+// Total milliseconds recorded for `phase` in this process (0 when the
+// phase never ran); used by the boot telemetry record
+double phase_total_ms(const std::string& phase);
+
+// Persist the aggregated timings next to the runtime state (RUN_DIR),
+// so `api timings` can serve them after the mount process exits
+bool save_phase_timings();
+
+// Aggregated timings as a JSON document: in-process samples when any
+// were recorded, otherwise the persisted file from the last mount
+std::string export_timings_json();
+
+}  // namespace hymo
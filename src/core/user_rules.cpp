@@ -161,25 +161,24 @@ void apply_user_hide_rules() {
         return;
     }
 
-    int success = 0;
-    int failed = 0;
-
     if (!HymoFS::is_available()) {
         LOG_WARN("HymoFS not available, cannot apply user hide rules");
         return;
     }
 
+    // One bulk submission instead of an ioctl per rule; hide_paths also
+    // drops duplicate entries from hand-edited rule files
+    std::vector<std::string> paths;
+    paths.reserve(rules.size());
     for (const auto& rule : rules) {
-        if (HymoFS::hide_path(rule.path)) {
-            success++;
-        } else {
-            failed++;
-            LOG_WARN("Failed to apply user hide rule: " + rule.path);
-        }
+        paths.push_back(rule.path);
     }
 
-    LOG_INFO("Applied user hide rules: " + std::to_string(success) + " success, " +
-             std::to_string(failed) + " failed");
+    if (HymoFS::hide_paths(paths)) {
+        LOG_INFO("Applied " + std::to_string(paths.size()) + " user hide rules");
+    } else {
+        LOG_WARN("Some user hide rules failed to apply");
+    }
 }
 
 }  // namespace hymo
@@ -0,0 +1,218 @@
+// core/watch.cpp - Inotify-driven incremental replan implementation
+#include "watch.hpp"
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "../defs.hpp"
+#include "../dirwalk.hpp"
+#include "../mount/hymofs.hpp"
+#include "../utils.hpp"
+#include "hotmount.hpp"
+#include "inventory.hpp"
+#include "state.hpp"
+#include "sync.hpp"
+
+namespace hymo {
+
+// Quiet window after the last event before we replan; editors and
+// package installs emit bursts, and only the final state matters
+static constexpr int WATCH_SETTLE_MS = 500;
+
+static constexpr uint32_t WATCH_DIR_MASK =
+    IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB;
+
+struct WatchedDir {
+    std::string module_id;
+    fs::path dir;
+};
+
+// Register `dir` and every directory below it, attributing their
+// events to `module_id`. inotify is not recursive on its own.
+static void watch_tree(int inotify_fd, const fs::path& dir, const std::string& module_id,
+                       std::map<int, WatchedDir>& watches) {
+    int wd = inotify_add_watch(inotify_fd, dir.c_str(), WATCH_DIR_MASK);
+    if (wd >= 0) {
+        watches[wd] = {module_id, dir};
+    }
+    walk_directory(dir, "", [&](const WalkEntry& e) {
+        if (e.type == DT_DIR) {
+            int sub = inotify_add_watch(inotify_fd, e.path.c_str(), WATCH_DIR_MASK);
+            if (sub >= 0) {
+                watches[sub] = {module_id, fs::path(e.path)};
+            }
+        }
+        return WalkControl::Recurse;
+    });
+}
+
+static std::vector<std::string> watched_partitions(const Config& config) {
+    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
+    all_partitions.insert(all_partitions.end(), config.partitions.begin(),
+                          config.partitions.end());
+    std::sort(all_partitions.begin(), all_partitions.end());
+    all_partitions.erase(std::unique(all_partitions.begin(), all_partitions.end()),
+                         all_partitions.end());
+    return all_partitions;
+}
+
+// Drop every active rule the module contributed. Removal enumerates
+// targets from the source tree; when the source is already gone (module
+// deleted) the synced storage copy still knows what was mounted.
+static void remove_module_rules(const Config& config, const std::string& module_id,
+                                const fs::path& storage_root) {
+    fs::path module_path = config.moduledir / module_id;
+    if (!fs::is_directory(module_path) && !storage_root.empty()) {
+        module_path = storage_root / module_id;
+    }
+
+    for (const auto& part : watched_partitions(config)) {
+        fs::path src_dir = module_path / part;
+        if (fs::exists(src_dir) && fs::is_directory(src_dir)) {
+            HymoFS::remove_rules_from_directory(fs::path("/") / part, src_dir);
+        }
+    }
+}
+
+int run_watch(const Config& config) {
+    if (!fs::is_directory(config.moduledir)) {
+        LOG_ERROR("Watch: module directory does not exist: " + config.moduledir.string());
+        return 1;
+    }
+
+    int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        LOG_ERROR("Watch: inotify_init1 failed: " + std::string(strerror(errno)));
+        return 1;
+    }
+
+    // Top-level watch catches whole modules appearing or disappearing;
+    // the event's name field is the module id
+    int top_wd = inotify_add_watch(inotify_fd, config.moduledir.c_str(),
+                                   IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+    if (top_wd < 0) {
+        LOG_ERROR("Watch: cannot watch " + config.moduledir.string() + ": " +
+                  std::string(strerror(errno)));
+        close(inotify_fd);
+        return 1;
+    }
+
+    // Targeted re-syncs land in the same storage copy the boot path
+    // filled, so the next boot sees the content the live rules describe
+    RuntimeState state = load_runtime_state();
+    fs::path storage_root = state.mount_point;
+    if (storage_root.empty()) {
+        LOG_WARN("Watch: no active storage mount recorded; skipping storage re-sync");
+    }
+
+    std::map<int, WatchedDir> watches;
+    for (const auto& module : scan_modules(config.moduledir, config)) {
+        watch_tree(inotify_fd, module.source_path, module.id, watches);
+    }
+
+    LOG_INFO("Watching " + config.moduledir.string() + " (" + std::to_string(watches.size()) +
+             " directories)");
+    std::cout << "Watching " << config.moduledir.string()
+              << " for module changes. Ctrl-C to stop.\n";
+
+    std::set<std::string> dirty;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (true) {
+        struct pollfd pfd = {inotify_fd, POLLIN, 0};
+        // Block when idle; once something is dirty, wait only for the
+        // settle window so a burst coalesces into one replan
+        int ready = poll(&pfd, 1, dirty.empty() ? -1 : WATCH_SETTLE_MS);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("Watch: poll failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        if (ready > 0) {
+            ssize_t len = read(inotify_fd, buf, sizeof(buf));
+            if (len <= 0)
+                continue;
+
+            for (char* p = buf; p < buf + len;) {
+                auto* ev = (struct inotify_event*)p;
+                p += sizeof(struct inotify_event) + ev->len;
+
+                if (ev->wd == top_wd) {
+                    if (ev->len > 0)
+                        dirty.insert(ev->name);
+                    continue;
+                }
+
+                auto it = watches.find(ev->wd);
+                if (it == watches.end())
+                    continue;
+                if (ev->mask & IN_IGNORED) {
+                    watches.erase(it);
+                    continue;
+                }
+
+                dirty.insert(it->second.module_id);
+
+                // Extend coverage into new subtrees before files land there
+                if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                    ev->len > 0) {
+                    watch_tree(inotify_fd, it->second.dir / ev->name, it->second.module_id,
+                               watches);
+                }
+            }
+            continue;
+        }
+
+        // Settle window elapsed: replan only what changed
+        std::vector<Module> modules = scan_modules(config.moduledir, config);
+        for (const auto& id : dirty) {
+            const Module* module = nullptr;
+            for (const auto& m : modules) {
+                if (m.id == id) {
+                    module = &m;
+                    break;
+                }
+            }
+
+            remove_module_rules(config, id, storage_root);
+
+            if (!module) {
+                // Deleted or disabled since the last pass; dropping its
+                // rules is the whole update
+                LOG_INFO("Watch: module removed, rules dropped: " + id);
+                std::cout << "Removed " << id << "\n";
+                continue;
+            }
+
+            if (!storage_root.empty()) {
+                sync_module(*module, storage_root, config);
+            }
+
+            if (hot_mount_module(config, id)) {
+                LOG_INFO("Watch: replanned module " + id);
+                std::cout << "Updated " << id << "\n";
+            } else {
+                LOG_WARN("Watch: rule resubmission failed for " + id);
+                std::cout << "Failed to update " << id << "\n";
+            }
+
+            // A freshly installed module brings unwatched directories
+            watch_tree(inotify_fd, module->source_path, id, watches);
+        }
+        dirty.clear();
+    }
+
+    close(inotify_fd);
+    return 1;
+}
+
+}  // namespace hymo
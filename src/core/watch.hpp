@@ -0,0 +1,15 @@
+// core/watch.hpp - Inotify-driven incremental replan
+#pragma once
+
+#include "../conf/config.hpp"
+
+namespace hymo {
+
+// Foreground watcher over the module source directory. Edits are
+// attributed to the module they landed in; that module alone is
+// re-synced through the incremental path and its HymoFS rules are
+// resubmitted, so development iteration never pays for a full remount.
+// Runs until terminated; returns a process exit code.
+int run_watch(const Config& config);
+
+}  // namespace hymo
@@ -1,83 +1,79 @@
 // core/webui.cpp - WebUI API interface implementation
 #include "webui.hpp"
 #include <fstream>
-#include <iomanip>
-#include <sstream>
 #include "../defs.hpp"
+#include "../mount/hymofs.hpp"
 #include "../mount/magic.hpp"
 #include "../mount/partition_utils.hpp"
 #include "../utils.hpp"
+#include "json_writer.hpp"
 #include "state.hpp"
 
 namespace hymo {
 
-static std::string escape_json_string(const std::string& str) {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-        case '"':
-            oss << "\\\"";
-            break;
-        case '\\':
-            oss << "\\\\";
-            break;
-        case '\n':
-            oss << "\\n";
-            break;
-        case '\r':
-            oss << "\\r";
-            break;
-        case '\t':
-            oss << "\\t";
-            break;
-        default:
-            oss << c;
-            break;
-        }
-    }
-    return oss.str();
-}
-
 std::string export_mount_stats_json() {
     auto stats = get_mount_statistics();
 
-    std::ostringstream json;
-    json << "{"
-         << "\"total_mounts\":" << stats.total_mounts << ","
-         << "\"successful_mounts\":" << stats.successful_mounts << ","
-         << "\"failed_mounts\":" << stats.failed_mounts << ","
-         << "\"tmpfs_created\":" << stats.tmpfs_created << ","
-         << "\"files_mounted\":" << stats.files_mounted << ","
-         << "\"dirs_mounted\":" << stats.dirs_mounted << ","
-         << "\"symlinks_created\":" << stats.symlinks_created << ","
-         << "\"overlayfs_mounts\":" << stats.overlayfs_mounts << ","
-         << "\"success_rate\":" << std::fixed << std::setprecision(2) << stats.get_success_rate()
-         << "}";
-
-    return json.str();
+    json::Writer w(512);
+    w.begin_object();
+    w.key("total_mounts").value(stats.total_mounts);
+    w.key("successful_mounts").value(stats.successful_mounts);
+    w.key("failed_mounts").value(stats.failed_mounts);
+    w.key("tmpfs_created").value(stats.tmpfs_created);
+    w.key("files_mounted").value(stats.files_mounted);
+    w.key("dirs_mounted").value(stats.dirs_mounted);
+    w.key("symlinks_created").value(stats.symlinks_created);
+    w.key("overlayfs_mounts").value(stats.overlayfs_mounts);
+    w.key("success_rate").value_fixed(stats.get_success_rate(), 2);
+    w.end_object();
+
+    return w.str();
 }
 
 std::string export_partitions_json() {
     auto partitions = detect_partitions();
 
-    std::ostringstream json;
-    json << "[";
+    json::Writer w(2048);
+    w.begin_array();
+    for (const auto& p : partitions) {
+        w.begin_object();
+        w.key("name").value(p.name);
+        w.key("mount_point").value(p.mount_point.string());
+        w.key("fs_type").value(p.fs_type);
+        w.key("is_read_only").value(p.is_read_only);
+        w.key("exists_as_symlink").value(p.exists_as_symlink);
+        w.end_object();
+    }
+    w.end_array();
 
-    for (size_t i = 0; i < partitions.size(); i++) {
-        const auto& p = partitions[i];
-        if (i > 0)
-            json << ",";
+    return w.str();
+}
 
-        json << "{"
-             << "\"name\":\"" << escape_json_string(p.name) << "\","
-             << "\"mount_point\":\"" << escape_json_string(p.mount_point.string()) << "\","
-             << "\"fs_type\":\"" << escape_json_string(p.fs_type) << "\","
-             << "\"is_read_only\":" << (p.is_read_only ? "true" : "false") << ","
-             << "\"exists_as_symlink\":" << (p.exists_as_symlink ? "true" : "false") << "}";
+std::string export_hymofs_rules_json() {
+    // Streamed straight from the kernel listing: each parsed record is
+    // appended to the output as it arrives, so 100k+ rule sets never
+    // build a DOM or an intermediate text blob
+    json::Writer w(16384, 2);
+    w.begin_array();
+
+    if (HymoFS::is_available()) {
+        HymoFS::list_active_rules([&](const HymoActiveRule& rule) {
+            w.begin_object();
+            if (rule.type == "ADD" || rule.type == "MERGE") {
+                w.key("source").value(rule.source);
+                w.key("target").value(rule.target);
+            } else if (rule.type == "HIDE") {
+                w.key("path").value(rule.path);
+            } else if (!rule.args.empty()) {
+                w.key("args").value(rule.args);
+            }
+            w.key("type").value(rule.type);
+            w.end_object();
+        });
     }
 
-    json << "]";
-    return json.str();
+    w.end_array();
+    return w.str();
 }
 
 std::string export_system_info_json() {
@@ -107,25 +103,21 @@ std::string export_system_info_json() {
         selinux = (enforce == "0") ? "Permissive" : "Enforcing";
     }
 
-    // Get mount statistics
-    auto mount_stats = export_mount_stats_json();
-
-    // Get detected partitions
-    auto partitions = export_partitions_json();
-
     // Get mount base from runtime state or use default
     auto state = load_runtime_state();
     std::string mount_base = state.mount_point.empty() ? HYMO_MIRROR_DEV : state.mount_point;
 
-    std::ostringstream json;
-    json << "{"
-         << "\"kernel\":\"" << escape_json_string(kernel) << "\","
-         << "\"selinux\":\"" << selinux << "\","
-         << "\"mount_base\":\"" << escape_json_string(mount_base) << "\","
-         << "\"mountStats\":" << mount_stats << ","
-         << "\"detectedPartitions\":" << partitions << "}";
-
-    return json.str();
+    json::Writer w(4096);
+    w.begin_object();
+    w.key("kernel").value(kernel);
+    w.key("selinux").value(selinux);
+    w.key("mount_base").value(mount_base);
+    // Nested exports are already rendered JSON
+    w.key("mountStats").value_raw(export_mount_stats_json());
+    w.key("detectedPartitions").value_raw(export_partitions_json());
+    w.end_object();
+
+    return w.str();
 }
 
 }  // namespace hymo
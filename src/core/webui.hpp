@@ -26,4 +26,7 @@ std::string export_mount_stats_json();
 // Export detected partitions as JSON for WebUI
 std::string export_partitions_json();
 
+// Export active HymoFS rules as JSON for WebUI
+std::string export_hymofs_rules_json();
+
 }  // namespace hymo
@@ -12,6 +12,7 @@ constexpr const char* FALLBACK_CONTENT_DIR = "/data/adb/hymo/img_mnt/";
 constexpr const char* BASE_DIR = "/data/adb/hymo/";
 constexpr const char* RUN_DIR = "/data/adb/hymo/run/";
 constexpr const char* STATE_FILE = "/data/adb/hymo/run/daemon_state.json";
+constexpr const char* STATE_BIN_FILE = "/data/adb/hymo/run/daemon_state.bin";
 constexpr const char* MOUNT_STATS_FILE = "/data/adb/hymo/run/mount_stats.json";
 constexpr const char* DAEMON_LOG_FILE = "/data/adb/hymo/daemon.log";
 constexpr const char* SYSTEM_RW_DIR = "/data/adb/hymo/rw";
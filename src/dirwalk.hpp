@@ -0,0 +1,148 @@
+// dirwalk.hpp - Raw getdents64 directory walker
+//
+// fs::recursive_directory_iterator constructs a fs::path per entry and
+// stats entries the caller never looks at, which shows up in every hot
+// loop that scans module trees. This walker reads raw getdents64
+// batches, reuses one absolute and one relative path buffer across the
+// whole traversal, and trusts d_type so only entries the filesystem
+// reports as DT_UNKNOWN pay an lstat. The visitor is a template
+// parameter, so each entry costs a direct call instead of a
+// std::function dispatch.
+#pragma once
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace hymo {
+
+// stat mode bits to the matching DT_* constant
+inline int mode_to_dt(mode_t mode) {
+    switch (mode & S_IFMT) {
+    case S_IFREG:
+        return DT_REG;
+    case S_IFDIR:
+        return DT_DIR;
+    case S_IFLNK:
+        return DT_LNK;
+    case S_IFCHR:
+        return DT_CHR;
+    case S_IFBLK:
+        return DT_BLK;
+    case S_IFIFO:
+        return DT_FIFO;
+    case S_IFSOCK:
+        return DT_SOCK;
+    default:
+        return DT_UNKNOWN;
+    }
+}
+
+// What the visitor wants next: Recurse descends into a directory (a
+// no-op for other types), Skip leaves a directory's subtree unvisited,
+// Stop aborts the whole walk
+enum class WalkControl { Recurse, Skip, Stop };
+
+// One entry as the walker sees it. The strings reference buffers the
+// walker reuses across the traversal — copy them to retain. parent_fd
+// and name support fstatat() when the visitor needs more than d_type.
+struct WalkEntry {
+    const std::string& path;  // absolute path of the entry
+    const std::string& rel;   // relative to the walk root, '/'-prefixed
+    int type;                 // DT_*, resolved via lstat when DT_UNKNOWN
+    int parent_fd;            // containing directory
+    const char* name;         // basename within parent_fd
+};
+
+namespace detail {
+
+// The kernel's getdents64 record layout; bionic and glibc disagree on
+// how (and whether) they expose it, so declare it and call the syscall
+// directly
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    uint16_t d_reclen;
+    uint8_t d_type;
+    char d_name[];
+};
+
+template <class Visit>
+bool walk_fd(int dirfd, std::string& abs, std::string& rel, Visit& visit, bool& stop) {
+    char buf[8192];
+    for (;;) {
+        long n = syscall(SYS_getdents64, dirfd, buf, sizeof(buf));
+        if (n <= 0)
+            return n == 0;
+
+        for (long off = 0; off < n;) {
+            auto* de = reinterpret_cast<LinuxDirent64*>(buf + off);
+            off += de->d_reclen;
+            if (de->d_name[0] == '.' &&
+                (de->d_name[1] == '\0' || (de->d_name[1] == '.' && de->d_name[2] == '\0')))
+                continue;
+
+            size_t abs_len = abs.size();
+            size_t rel_len = rel.size();
+            abs += '/';
+            abs += de->d_name;
+            rel += '/';
+            rel += de->d_name;
+
+            int dt = de->d_type;
+            if (dt == DT_UNKNOWN) {
+                struct stat st;
+                if (fstatat(dirfd, de->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                    dt = mode_to_dt(st.st_mode);
+            }
+
+            WalkControl ctl = visit(WalkEntry{abs, rel, dt, dirfd, de->d_name});
+            if (ctl == WalkControl::Stop) {
+                stop = true;
+            } else if (dt == DT_DIR && ctl == WalkControl::Recurse) {
+                int sub = openat(dirfd, de->d_name,
+                                 O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                if (sub >= 0) {
+                    walk_fd(sub, abs, rel, visit, stop);
+                    close(sub);
+                }
+            }
+
+            abs.resize(abs_len);
+            rel.resize(rel_len);
+            if (stop)
+                return true;
+        }
+    }
+}
+
+}  // namespace detail
+
+// Depth-first walk of root; directories are visited before their
+// contents, so a subtree follows its directory entry contiguously. The
+// entry's rel path starts from rel_prefix (pass "" for paths relative
+// to root itself). Returns false when root cannot be opened.
+template <class Visit>
+bool walk_directory(const fs::path& root, std::string rel_prefix, Visit&& visit) {
+    int fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    std::string abs = root.string();
+    while (!abs.empty() && abs.back() == '/')
+        abs.pop_back();
+
+    bool stop = false;
+    bool ok = detail::walk_fd(fd, abs, rel_prefix, visit, stop);
+    close(fd);
+    return ok || stop;
+}
+
+}  // namespace hymo
@@ -10,15 +10,23 @@
 #include <set>
 #include <sstream>
 #include "conf/config.hpp"
+#include "core/daemon.hpp"
 #include "core/executor.hpp"
+#include "core/hotmount.hpp"
 #include "core/inventory.hpp"
 #include "core/json.hpp"
 #include "core/modules.hpp"
+#include "core/path_index.hpp"
+#include "core/plan_cache.hpp"
 #include "core/planner.hpp"
+#include "core/prefetch.hpp"
 #include "core/state.hpp"
 #include "core/storage.hpp"
 #include "core/sync.hpp"
+#include "core/telemetry.hpp"
+#include "core/timings.hpp"
 #include "core/user_rules.hpp"
+#include "core/watch.hpp"
 #include "core/webui.hpp"
 #include "defs.hpp"
 #include "mount/hymofs.hpp"
@@ -34,6 +42,7 @@ struct CliOptions {
     fs::path tempdir;
     std::string mountsource;
     bool verbose = false;
+    bool no_plan_cache = false;
     std::vector<std::string> partitions;
     std::string output;
     std::vector<std::string> args;
@@ -43,6 +52,8 @@ static void print_help() {
     std::cout << "Usage: hymod [OPTIONS] <command> [args...]\n\n";
     std::cout << "Main Commands:\n";
     std::cout << "  mount              Mount all modules (default action)\n";
+    std::cout << "  daemon             Stay resident and serve queries over a UNIX socket\n";
+    std::cout << "  watch              Watch the module dir and replan changed modules live\n";
     std::cout << "  clear              Clear all HymoFS mappings\n";
     std::cout << "  fix-mounts         Fix mount namespace issues\n\n";
 
@@ -75,7 +86,11 @@ static void print_help() {
     std::cout << "  api system         Complete system info with stats\n";
     std::cout << "  api storage        Storage usage information\n";
     std::cout << "  api mount-stats    Mount statistics\n";
-    std::cout << "  api partitions     Detected partitions info\n\n";
+    std::cout << "  api partitions     Detected partitions info\n";
+    std::cout << "  api timings        Mount pipeline phase timings\n";
+    std::cout << "  api conflicts      Files provided by more than one module\n";
+    std::cout << "  api hotmount-status  Progress of the current hot-mount\n";
+    std::cout << "  api history        Per-boot pipeline telemetry (last boots)\n\n";
 
     std::cout << "Privacy Commands (hide <subcommand>):\n";
     std::cout << "  hide list          List user-defined hide rules\n";
@@ -86,7 +101,8 @@ static void print_help() {
     std::cout << "  debug enable       Enable kernel debug logging\n";
     std::cout << "  debug disable      Disable kernel debug logging\n";
     std::cout << "  debug stealth on|off    Enable/disable stealth mode\n";
-    std::cout << "  debug set-uname <release> <version>  Set kernel version spoofing\n\n";
+    std::cout << "  debug set-uname <release> <version>  Set kernel version spoofing\n";
+    std::cout << "  debug state        Dump runtime state as JSON\n\n";
 
     std::cout << "Options:\n";
     std::cout << "  -c, --config FILE       Config file path\n";
@@ -97,6 +113,7 @@ static void print_help() {
     std::cout << "  -p, --partition NAME    Add partition (can be used multiple "
                  "times)\n";
     std::cout << "  -o, --output FILE       Output file (for gen-config)\n";
+    std::cout << "      --no-plan-cache     Skip the persistent mount plan cache\n";
     std::cout << "  -h, --help              Show this help\n";
     std::cout << "\nExamples:\n";
     std::cout << "\nExamples:\n";
@@ -147,6 +164,61 @@ static void segregate_custom_rules(MountPlan& plan, const fs::path& mirror_dir)
     // Magic mount paths are module source directories, not overlay layers
 }
 
+// A cached plan references segregated layer paths, but the mirror is rebuilt
+// every boot with layers at their original locations - replay the moves that
+// segregate_custom_rules() performed when the plan was generated.
+static void replay_segregation(const MountPlan& plan, const fs::path& mirror_dir) {
+    fs::path staging_dir = mirror_dir / ".overlay_staging";
+    std::string staging_str = staging_dir.string();
+
+    for (const auto& op : plan.overlay_ops) {
+        for (const auto& layer : op.lowerdirs) {
+            std::string layer_str = layer.string();
+            if (layer_str.compare(0, staging_str.size(), staging_str) != 0)
+                continue;
+            if (fs::exists(layer))
+                continue;
+
+            fs::path rel = fs::relative(layer, staging_dir);
+            fs::path original = mirror_dir / rel;
+            try {
+                if (fs::exists(original)) {
+                    fs::create_directories(layer.parent_path());
+                    fs::rename(original, layer);
+                }
+            } catch (const std::exception& e) {
+                LOG_WARN("Failed to replay segregation for " + layer_str + " - " + e.what());
+            }
+        }
+    }
+}
+
+// Shared planning step for the mirror strategies: consult the persistent
+// plan cache first; on a miss, scan + plan + emit rules and refresh it.
+static void plan_hymofs_mappings(const Config& config, bool use_cache,
+                                 const std::vector<Module>& module_list,
+                                 const fs::path& mirror_dir, MountPlan& plan) {
+    fs::path cache_file = fs::path(BASE_DIR) / "plan_cache.bin";
+    uint64_t digest = compute_plan_digest(config, module_list, mirror_dir);
+
+    HymoFSRuleSet rule_set;
+    if (use_cache && load_plan_cache(cache_file, digest, plan, rule_set)) {
+        replay_segregation(plan, mirror_dir);
+        apply_hymofs_rules(config, rule_set);
+        return;
+    }
+
+    ModuleScanIndex scan_index = build_module_scan_index(config, module_list, mirror_dir);
+    plan = generate_plan(config, module_list, mirror_dir, scan_index);
+    segregate_custom_rules(plan, mirror_dir);
+    rule_set = emit_hymofs_rules(config, module_list, mirror_dir, plan, scan_index);
+    apply_hymofs_rules(config, rule_set);
+
+    if (use_cache) {
+        save_plan_cache(cache_file, digest, plan, rule_set);
+    }
+}
+
 static CliOptions parse_args(int argc, char* argv[]) {
     CliOptions opts;
 
@@ -157,6 +229,7 @@ static CliOptions parse_args(int argc, char* argv[]) {
                                            {"verbose", no_argument, 0, 'v'},
                                            {"partition", required_argument, 0, 'p'},
                                            {"output", required_argument, 0, 'o'},
+                                           {"no-plan-cache", no_argument, 0, 1},
                                            {"help", no_argument, 0, 'h'},
                                            {0, 0, 0, 0}};
 
@@ -186,6 +259,9 @@ static CliOptions parse_args(int argc, char* argv[]) {
         case 'o':
             opts.output = optarg;
             break;
+        case 1:
+            opts.no_plan_cache = true;
+            break;
         case 'h':
             print_help();
             exit(0);
@@ -208,19 +284,24 @@ static CliOptions parse_args(int argc, char* argv[]) {
 }
 
 static Config load_config(const CliOptions& opts) {
+    Config config;
     if (!opts.config_file.empty()) {
-        return Config::from_file(opts.config_file);
-    }
-
-    try {
-        return Config::load_default();
-    } catch (const std::exception& e) {
-        fs::path default_path = fs::path(BASE_DIR) / CONFIG_FILENAME;
-        if (fs::exists(default_path)) {
-            std::cerr << "Error loading config: " << e.what() << "\n";
+        config = Config::from_file(opts.config_file);
+    } else {
+        try {
+            config = Config::load_default();
+        } catch (const std::exception& e) {
+            fs::path default_path = fs::path(BASE_DIR) / CONFIG_FILENAME;
+            if (fs::exists(default_path)) {
+                std::cerr << "Error loading config: " << e.what() << "\n";
+            }
         }
-        return Config();
     }
+
+    // Every command that attaches an image goes through mount_image
+    set_loop_direct_io(config.loop_direct_io);
+    set_image_size_cap_mb(config.image_max_size_mb);
+    return config;
 }
 
 int main(int argc, char* argv[]) {
@@ -247,6 +328,8 @@ int main(int argc, char* argv[]) {
             FIX_MOUNTS,
             RAW,
             MOUNT,
+            DAEMON,
+            WATCH,
             UNKNOWN
         };
 
@@ -271,6 +354,10 @@ int main(int argc, char* argv[]) {
                 return Command::RAW;
             if (cmd == "mount")
                 return Command::MOUNT;
+            if (cmd == "daemon")
+                return Command::DAEMON;
+            if (cmd == "watch")
+                return Command::WATCH;
             return Command::UNKNOWN;
         };
 
@@ -400,6 +487,11 @@ int main(int argc, char* argv[]) {
             Config config = load_config(cli);
 
             if (subcmd == "list") {
+                std::string daemon_reply;
+                if (daemon_request("module list", daemon_reply)) {
+                    std::cout << daemon_reply << "\n";
+                    return 0;
+                }
                 print_module_list(config);
                 return 0;
             } else if (subcmd == "add" || subcmd == "delete") {
@@ -508,27 +600,9 @@ int main(int argc, char* argv[]) {
                         return 1;
                     }
 
-                    std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
-                    all_partitions.insert(all_partitions.end(), config.partitions.begin(),
-                                          config.partitions.end());
-                    std::sort(all_partitions.begin(), all_partitions.end());
-                    all_partitions.erase(std::unique(all_partitions.begin(), all_partitions.end()),
-                                         all_partitions.end());
-
-                    int success_count = 0;
-                    for (const auto& part : all_partitions) {
-                        fs::path src_dir = module_path / part;
-                        if (fs::exists(src_dir) && fs::is_directory(src_dir)) {
-                            fs::path target_base = fs::path("/") / part;
-                            if (HymoFS::add_rules_from_directory(target_base, src_dir)) {
-                                if (config.verbose)
-                                    std::cout << "Added rules for " << src_dir << "\n";
-                                success_count++;
-                            }
-                        }
-                    }
-
-                    if (success_count > 0) {
+                    // Pipelined engine: walk and bulk-submit overlap, and
+                    // the WebUI can follow along via `api hotmount-status`
+                    if (hot_mount_module(config, mod_id)) {
                         std::cout << "Successfully added module " << mod_id << "\n";
                         LOG_INFO("CLI: Hot mounted module " + mod_id);
 
@@ -562,6 +636,8 @@ int main(int argc, char* argv[]) {
 
                     fs::path module_path = config.moduledir / mod_id;
 
+                    hotmount_mark(mod_id, "unmounting");
+
                     int success_count = 0;
                     for (const auto& part : all_partitions) {
                         fs::path src_dir = module_path / part;
@@ -571,6 +647,8 @@ int main(int argc, char* argv[]) {
                         }
                     }
 
+                    hotmount_mark(mod_id, success_count > 0 ? "done" : "error");
+
                     if (success_count > 0) {
                         std::cout << "Successfully hot unmounted module " << mod_id << "\n";
                         LOG_INFO("CLI: Hot unmounted module " + mod_id);
@@ -666,71 +744,9 @@ int main(int argc, char* argv[]) {
                 }
                 return 0;
             } else if (subcmd == "check-conflicts") {
-                // Check for file conflicts between modules
-                auto module_list = scan_modules(config.moduledir, config);
-
-                std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
-                all_partitions.insert(all_partitions.end(), config.partitions.begin(),
-                                      config.partitions.end());
-
-                // Map: file path -> list of module IDs that modify it
-                std::map<std::string, std::vector<std::string>> file_map;
-
-                for (const auto& mod : module_list) {
-                    // Skip disabled modules
-                    if (fs::exists(mod.source_path / "disable"))
-                        continue;
-
-                    for (const auto& part : all_partitions) {
-                        fs::path part_dir = mod.source_path / part;
-                        if (!fs::exists(part_dir) || !fs::is_directory(part_dir))
-                            continue;
-
-                        // Walk through all files in this partition
-                        try {
-                            for (auto it = fs::recursive_directory_iterator(part_dir);
-                                 it != fs::recursive_directory_iterator(); ++it) {
-                                if (fs::is_regular_file(it->status()) ||
-                                    fs::is_symlink(it->status())) {
-                                    // Get relative path from partition root
-                                    fs::path rel = fs::relative(it->path(), part_dir);
-                                    std::string file_key = "/" + part + "/" + rel.string();
-                                    file_map[file_key].push_back(mod.id);
-                                }
-                            }
-                        } catch (const fs::filesystem_error& e) {
-                            // Skip inaccessible directories
-                            continue;
-                        }
-                    }
-                }
-
-                // Find conflicts (files modified by multiple modules)
-                std::cout << "[";
-                bool first = true;
-                for (const auto& [file_path, module_ids] : file_map) {
-                    if (module_ids.size() > 1) {
-                        if (!first)
-                            std::cout << ",";
-                        first = false;
-
-                        std::cout << "{\"file\":\"" << file_path << "\",\"modules\":[";
-                        for (size_t i = 0; i < module_ids.size(); ++i) {
-                            if (i > 0)
-                                std::cout << ",";
-                            std::cout << "\"" << module_ids[i] << "\"";
-                        }
-                        std::cout << "],\"message\":\"File '" << file_path << "' is modified by "
-                                  << module_ids.size() << " modules: ";
-                        for (size_t i = 0; i < module_ids.size(); ++i) {
-                            if (i > 0)
-                                std::cout << ", ";
-                            std::cout << module_ids[i];
-                        }
-                        std::cout << "\"}";
-                    }
-                }
-                std::cout << "]\n";
+                // Answered from the persisted inverted path index; only a
+                // stale index pays for a rebuild
+                std::cout << export_conflicts_json(config) << "\n";
                 return 0;
             } else {
                 std::cerr << "Unknown module subcommand: " << subcmd << "\n";
@@ -763,49 +779,12 @@ int main(int argc, char* argv[]) {
                 }
                 return 0;
             } else if (subcmd == "list") {
-                json::Value root = json::Value::array();
-                if (HymoFS::is_available()) {
-                    std::string rules_str = HymoFS::get_active_rules();
-                    std::istringstream iss(rules_str);
-                    std::string line;
-                    while (std::getline(iss, line)) {
-                        if (line.empty())
-                            continue;
-
-                        json::Value rule = json::Value::object();
-                        std::istringstream ls(line);
-                        std::string type;
-                        ls >> type;
-
-                        std::string type_upper = type;
-                        std::transform(type_upper.begin(), type_upper.end(), type_upper.begin(),
-                                       ::toupper);
-
-                        rule["type"] = json::Value(type_upper);
-
-                        if (type_upper == "ADD" || type_upper == "MERGE") {
-                            std::string target, source;
-                            ls >> target >> source;
-                            rule["target"] = json::Value(target);
-                            rule["source"] = json::Value(source);
-                        } else if (type_upper == "HIDE") {
-                            std::string path;
-                            ls >> path;
-                            rule["path"] = json::Value(path);
-                        } else {
-                            std::string rest;
-                            std::getline(ls, rest);
-                            if (!rest.empty()) {
-                                size_t first = rest.find_first_not_of(" ");
-                                if (first != std::string::npos)
-                                    rest = rest.substr(first);
-                                rule["args"] = json::Value(rest);
-                            }
-                        }
-                        root.push_back(rule);
-                    }
+                std::string daemon_reply;
+                if (daemon_request("hymofs list", daemon_reply)) {
+                    std::cout << daemon_reply << "\n";
+                    return 0;
                 }
-                std::cout << json::dump(root, 2) << "\n";
+                std::cout << export_hymofs_rules_json() << "\n";
                 return 0;
             } else if (subcmd == "version") {
                 std::cout << "{\n";
@@ -954,11 +933,22 @@ int main(int argc, char* argv[]) {
 
         case Command::API: {
             if (cli.args.empty()) {
-                std::cerr << "Usage: hymod api <system|storage|mount-stats|partitions>\n";
+                std::cerr
+                    << "Usage: hymod api "
+                       "<system|storage|mount-stats|partitions|timings|conflicts|"
+                       "hotmount-status|history>\n";
                 return 1;
             }
             std::string subcmd = cli.args[0];
 
+            // Prefer a running daemon: it answers from warm state without
+            // re-probing the kernel on every dashboard poll
+            std::string daemon_reply;
+            if (daemon_request("api " + subcmd, daemon_reply)) {
+                std::cout << daemon_reply << "\n";
+                return 0;
+            }
+
             if (subcmd == "system") {
                 std::cout << export_system_info_json() << std::endl;
             } else if (subcmd == "storage") {
@@ -967,9 +957,19 @@ int main(int argc, char* argv[]) {
                 std::cout << export_mount_stats_json() << std::endl;
             } else if (subcmd == "partitions") {
                 std::cout << export_partitions_json() << std::endl;
+            } else if (subcmd == "timings") {
+                std::cout << export_timings_json() << std::endl;
+            } else if (subcmd == "conflicts") {
+                Config config = load_config(cli);
+                std::cout << export_conflicts_json(config) << std::endl;
+            } else if (subcmd == "hotmount-status") {
+                std::cout << export_hotmount_status_json() << std::endl;
+            } else if (subcmd == "history") {
+                std::cout << export_telemetry_history_json() << std::endl;
             } else {
                 std::cerr << "Unknown api subcommand: " << subcmd << "\n";
-                std::cerr << "Available: system, storage, mount-stats, partitions\n";
+                std::cerr << "Available: system, storage, mount-stats, partitions, timings, "
+                             "conflicts, hotmount-status, history\n";
                 return 1;
             }
             return 0;
@@ -977,12 +977,16 @@ int main(int argc, char* argv[]) {
 
         case Command::DEBUG: {
             if (cli.args.empty()) {
-                std::cerr << "Usage: hymod debug <enable|disable|stealth|set-uname>\n";
+                std::cerr << "Usage: hymod debug <enable|disable|stealth|set-uname|state>\n";
                 return 1;
             }
             std::string subcmd = cli.args[0];
 
-            if (subcmd == "enable" || subcmd == "disable") {
+            if (subcmd == "state") {
+                // Human-readable dump of the binary runtime state
+                std::cout << load_runtime_state().to_json();
+                return 0;
+            } else if (subcmd == "enable" || subcmd == "disable") {
                 bool enable = (subcmd == "enable");
                 if (HymoFS::is_available()) {
                     if (HymoFS::set_debug(enable)) {
@@ -1062,7 +1066,7 @@ int main(int argc, char* argv[]) {
                 return 0;
             } else {
                 std::cerr << "Unknown debug subcommand: " << subcmd << "\n";
-                std::cerr << "Available: enable, disable, stealth, set-uname\n";
+                std::cerr << "Available: enable, disable, stealth, set-uname, state\n";
                 return 1;
             }
         }
@@ -1140,6 +1144,16 @@ int main(int argc, char* argv[]) {
             std::cerr << "Use 'hymod hymofs raw <cmd> ...' for raw commands\n";
             return 1;
 
+        case Command::DAEMON: {
+            Config config = load_config(cli);
+            return run_daemon(config);
+        }
+
+        case Command::WATCH: {
+            Config config = load_config(cli);
+            return run_watch(config);
+        }
+
         case Command::MOUNT:
             // Fall through to mount logic below
             break;
@@ -1290,14 +1304,7 @@ int main(int argc, char* argv[]) {
                 all_partitions.push_back(part);
 
             for (const auto& mod : module_list) {
-                bool has_content = false;
-                for (const auto& part : all_partitions) {
-                    if (has_files_recursive(mod.source_path / part)) {
-                        has_content = true;
-                        break;
-                    }
-                }
-                if (has_content) {
+                if (module_has_content(mod.source_path, all_partitions)) {
                     active_modules.push_back(mod);
                 } else {
                     LOG_DEBUG("Skipping empty module: " + mod.id);
@@ -1344,12 +1351,15 @@ int main(int argc, char* argv[]) {
                              " active modules to EROFS staging...");
 
                     bool sync_ok = true;
-                    for (const auto& mod : module_list) {
-                        fs::path src = config.moduledir / mod.id;
-                        fs::path dst = staging_dir / mod.id;
-                        if (!sync_dir(src, dst)) {
-                            LOG_ERROR("Failed to sync module: " + mod.id);
-                            sync_ok = false;
+                    {
+                        ScopedTimer sync_timer("sync");
+                        for (const auto& mod : module_list) {
+                            fs::path src = config.moduledir / mod.id;
+                            fs::path dst = staging_dir / mod.id;
+                            if (!sync_dir(src, dst)) {
+                                LOG_ERROR("Failed to sync module: " + mod.id);
+                                sync_ok = false;
+                            }
                         }
                     }
 
@@ -1358,15 +1368,15 @@ int main(int argc, char* argv[]) {
                         umount(MIRROR_DIR.c_str());
                     } else {
                         storage = setup_erofs_storage(MIRROR_DIR, staging_dir,
-                                                      fs::path(BASE_DIR) / "modules.erofs");
+                                                      fs::path(BASE_DIR) / "modules.erofs",
+                                                      config.erofs_deferred_rebuild);
                         mirror_success = true;
                         hymofs_active = true;
 
                         // Plan should be generated from the mirrored storage root.
-                        plan = generate_plan(config, module_list, MIRROR_DIR);
-                        segregate_custom_rules(plan, MIRROR_DIR);
-                        update_hymofs_mappings(config, module_list, MIRROR_DIR, plan);
-                        exec_result = execute_plan(plan, config, hymofs_active);
+                        plan_hymofs_mappings(config, !cli.no_plan_cache, module_list, MIRROR_DIR,
+                                             plan);
+                        exec_result = execute_plan_phased(plan, config, hymofs_active, module_list);
 
                         if (config.enable_stealth) {
                             if (HymoFS::fix_mounts()) {
@@ -1381,13 +1391,19 @@ int main(int argc, char* argv[]) {
                     LOG_INFO("Syncing " + std::to_string(module_list.size()) +
                              " active modules to mirror...");
 
+                    // Grow the image online first if the sync would overflow it
+                    ensure_ext4_capacity(storage, img_path, config.moduledir);
+
                     bool sync_ok = true;
-                    for (const auto& mod : module_list) {
-                        fs::path src = config.moduledir / mod.id;
-                        fs::path dst = MIRROR_DIR / mod.id;
-                        if (!sync_dir(src, dst)) {
-                            LOG_ERROR("Failed to sync module: " + mod.id);
-                            sync_ok = false;
+                    {
+                        ScopedTimer sync_timer("sync");
+                        for (const auto& mod : module_list) {
+                            fs::path src = config.moduledir / mod.id;
+                            fs::path dst = MIRROR_DIR / mod.id;
+                            if (!sync_dir(src, dst)) {
+                                LOG_ERROR("Failed to sync module: " + mod.id);
+                                sync_ok = false;
+                            }
                         }
                     }
 
@@ -1401,12 +1417,9 @@ int main(int argc, char* argv[]) {
                         hymofs_active = true;
 
                         // Plan should be generated from the mirrored storage root.
-                        plan = generate_plan(config, module_list, MIRROR_DIR);
-
-                        // Prepare plan and update mappings
-                        segregate_custom_rules(plan, MIRROR_DIR);
-                        update_hymofs_mappings(config, module_list, MIRROR_DIR, plan);
-                        exec_result = execute_plan(plan, config, hymofs_active);
+                        plan_hymofs_mappings(config, !cli.no_plan_cache, module_list, MIRROR_DIR,
+                                             plan);
+                        exec_result = execute_plan_phased(plan, config, hymofs_active, module_list);
 
                         if (config.enable_stealth) {
                             if (HymoFS::fix_mounts()) {
@@ -1440,27 +1453,18 @@ int main(int argc, char* argv[]) {
                 plan.magic_module_paths.clear();
 
                 for (const auto& mod : module_list) {
-                    // Check if module has content
-                    bool has_content = false;
                     std::vector<std::string> all_partitions = BUILTIN_PARTITIONS;
                     for (const auto& part : config.partitions)
                         all_partitions.push_back(part);
 
-                    for (const auto& part : all_partitions) {
-                        if (has_files_recursive(mod.source_path / part)) {
-                            has_content = true;
-                            break;
-                        }
-                    }
-
-                    if (has_content) {
+                    if (module_has_content(mod.source_path, all_partitions)) {
                         plan.magic_module_paths.push_back(mod.source_path);
                         exec_result.magic_module_ids.push_back(mod.id);
                     }
                 }
 
                 // Execute plan
-                exec_result = execute_plan(plan, config, hymofs_active);
+                exec_result = execute_plan_phased(plan, config, hymofs_active, module_list);
             }
 
         } else {
@@ -1502,8 +1506,12 @@ int main(int argc, char* argv[]) {
 
                 perform_sync(module_list, staging_dir, config);
                 storage = setup_erofs_storage(mnt_base, staging_dir,
-                                              fs::path(BASE_DIR) / "modules.erofs");
+                                              fs::path(BASE_DIR) / "modules.erofs",
+                                              config.erofs_deferred_rebuild);
             } else {
+                // Grow the image online first if the sync would overflow it
+                ensure_ext4_capacity(storage, img_path, config.moduledir);
+
                 perform_sync(module_list, storage.mount_point, config);
 
                 // **FIX 1: Fix permissions after sync**
@@ -1514,10 +1522,21 @@ int main(int argc, char* argv[]) {
 
             // **Step 4: Generate Plan**
             LOG_INFO("Generating mount plan...");
-            plan = generate_plan(config, module_list, storage.mount_point);
+            fs::path cache_file = fs::path(BASE_DIR) / "plan_cache.bin";
+            uint64_t plan_digest = compute_plan_digest(config, module_list, storage.mount_point);
+            HymoFSRuleSet cached_rules;  // unused on the legacy path
+            if (cli.no_plan_cache ||
+                !load_plan_cache(cache_file, plan_digest, plan, cached_rules)) {
+                ModuleScanIndex scan_index =
+                    build_module_scan_index(config, module_list, storage.mount_point);
+                plan = generate_plan(config, module_list, storage.mount_point, scan_index);
+                if (!cli.no_plan_cache) {
+                    save_plan_cache(cache_file, plan_digest, plan, {});
+                }
+            }
 
             // **Step 5: Execute Plan**
-            exec_result = execute_plan(plan, config, hymofs_active);
+            exec_result = execute_plan_phased(plan, config, hymofs_active, module_list);
         }
 
         LOG_INFO("Plan: " + std::to_string(exec_result.overlay_module_ids.size()) +
@@ -1525,6 +1544,10 @@ int main(int argc, char* argv[]) {
                  " Magic modules, " + std::to_string(plan.hymofs_module_ids.size()) +
                  " HymoFS modules");
 
+        // Optional page-cache warm-up for the content the plan just
+        // exposed; detaches immediately, boot is not delayed
+        start_prefetch(plan, storage.mount_point, config);
+
         // **Step 6: KSU Nuke (Stealth)**
         bool nuke_active = false;
         if (storage.mode == "ext4" && config.enable_nuke) {
@@ -1639,6 +1662,27 @@ int main(int argc, char* argv[]) {
         if (!state.save()) {
             LOG_ERROR("Failed to save runtime state");
         }
+        save_phase_timings();
+
+        // One telemetry record per boot; the ring answers `api history`
+        BootTelemetry boot_record;
+        boot_record.boot_ts = (uint64_t)time(nullptr);
+        boot_record.sync_ms = (uint32_t)phase_total_ms("sync");
+        boot_record.plan_ms =
+            (uint32_t)(phase_total_ms("generate_plan") + phase_total_ms("hymofs_emit"));
+        boot_record.rules_ms = (uint32_t)phase_total_ms("hymofs_apply");
+        boot_record.exec_ms = (uint32_t)phase_total_ms("execute_plan");
+        boot_record.magic_ms = (uint32_t)phase_total_ms("magic_mount");
+        boot_record.module_count = (uint32_t)module_list.size();
+        boot_record.rule_count = (uint32_t)telemetry_rule_count();
+        // Modules that landed in magic beyond what the plan asked for
+        // are overlay fallbacks
+        boot_record.fallback_count =
+            exec_result.magic_module_ids.size() > plan.magic_module_ids.size()
+                ? (uint32_t)(exec_result.magic_module_ids.size() - plan.magic_module_ids.size())
+                : 0;
+        boot_record.storage_mode = storage.mode;
+        record_boot_telemetry(boot_record);
 
         // Update module description
         update_module_description(true, storage.mode, nuke_active,
@@ -48,6 +48,46 @@ struct hymo_syscall_list_arg {
     size_t size;
 };
 
+/*
+ * Bulk rule submission - one ioctl carries many add/merge/hide rules.
+ * Kernels without HYMO_FEATURE_BULK_RULES reject the ioctl and userspace
+ * falls back to per-rule submission.
+ */
+#define HYMO_BATCH_OP_ADD 0
+#define HYMO_BATCH_OP_MERGE 1
+#define HYMO_BATCH_OP_HIDE 2
+
+/* Upper bound per ioctl; larger sets are chunked by userspace */
+#define HYMO_BULK_MAX_RULES 4096
+
+struct hymo_batch_rule {
+    const char* src;
+    const char* target; /* NULL for hide rules */
+    int type;           /* DT_* for add rules, 0 otherwise */
+    int op;             /* HYMO_BATCH_OP_* */
+};
+
+struct hymo_syscall_batch_arg {
+    const struct hymo_batch_rule* rules;
+    size_t count;
+};
+
+/*
+ * Paged rule listing - the kernel fills buf with newline-terminated rule
+ * lines, never splitting a line across pages, and advances the cursor.
+ * cursor == 0 on entry starts a fresh listing; the kernel writes the
+ * cursor for the next page, or 0 when the listing is complete. size is
+ * the buffer capacity on entry and the bytes written on return. Kernels
+ * without HYMO_FEATURE_PAGED_LIST reject the ioctl and userspace falls
+ * back to the fixed-buffer listing.
+ */
+struct hymo_syscall_list_page_arg {
+    uint64_t cursor;
+    char* buf;
+    size_t size;
+    uint32_t count; /* rules written into this page */
+};
+
 /*
  * kstat spoofing structure - allows full control over stat() results
  * Similar to susfs sus_kstat but with HymoFS conventions
@@ -101,6 +141,8 @@ struct hymo_spoof_cmdline {
 #define HYMO_FEATURE_CMDLINE_SPOOF (1 << 2)
 #define HYMO_FEATURE_SELINUX_BYPASS (1 << 4)
 #define HYMO_FEATURE_MERGE_DIR (1 << 5)
+#define HYMO_FEATURE_BULK_RULES (1 << 6)
+#define HYMO_FEATURE_PAGED_LIST (1 << 7)
 
 // ioctl definitions (for fd-based mode)
 // Must be after struct definitions
@@ -123,5 +165,7 @@ struct hymo_spoof_cmdline {
 #define HYMO_IOC_SET_CMDLINE _IOW(HYMO_IOC_MAGIC, 18, struct hymo_spoof_cmdline)
 #define HYMO_IOC_GET_FEATURES _IOR(HYMO_IOC_MAGIC, 19, int)
 #define HYMO_IOC_SET_ENABLED _IOW(HYMO_IOC_MAGIC, 20, int)
+#define HYMO_IOC_ADD_RULES_BULK _IOW(HYMO_IOC_MAGIC, 21, struct hymo_syscall_batch_arg)
+#define HYMO_IOC_LIST_RULES_PAGED _IOWR(HYMO_IOC_MAGIC, 22, struct hymo_syscall_list_page_arg)
 
 #endif /* _LINUX_HYMO_MAGIC_H */
\ No newline at end of file
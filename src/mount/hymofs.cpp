@@ -4,8 +4,12 @@
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <string_view>
+#include <unordered_set>
+#include "../dirwalk.hpp"
 #include "../utils.hpp"
 #include "hymo_magic.h"
 
@@ -169,33 +173,138 @@ bool HymoFS::hide_path(const std::string& path) {
     return ret;
 }
 
-bool HymoFS::add_rules_from_directory(const fs::path& target_base, const fs::path& module_dir) {
-    if (!fs::exists(module_dir) || !fs::is_directory(module_dir))
+bool HymoFS::hide_paths(const std::vector<std::string>& paths) {
+    if (paths.empty())
+        return true;
+
+    // Large hide sets routinely carry duplicates (module whiteouts and
+    // user rules overlapping); submit each path once
+    std::unordered_set<std::string_view> seen;
+    std::vector<HymoBatchRule> batch;
+    batch.reserve(paths.size());
+    for (const auto& path : paths) {
+        if (!seen.insert(path).second)
+            continue;
+        HymoBatchRule rule;
+        rule.src = path;
+        rule.op = HYMO_BATCH_OP_HIDE;
+        batch.push_back(std::move(rule));
+    }
+
+    LOG_INFO("HymoFS: Hiding " + std::to_string(batch.size()) + " paths (" +
+             std::to_string(paths.size() - batch.size()) + " duplicates dropped)");
+    return add_rules_batch(batch);
+}
+
+int HymoFS::get_features() {
+    static int s_features = -1;
+    if (s_features >= 0) {
+        return s_features;
+    }
+
+    int fd = get_anon_fd();
+    if (fd < 0) {
+        return 0;
+    }
+
+    int features = 0;
+    if (ioctl(fd, HYMO_IOC_GET_FEATURES, &features) != 0) {
+        LOG_WARN("HymoFS: get_features failed: " + std::string(strerror(errno)));
+        features = 0;
+    }
+    s_features = features;
+    LOG_VERBOSE("HymoFS: kernel features = " + std::to_string(features));
+    return s_features;
+}
+
+// Submit a single rule through the legacy per-rule ioctls
+static bool submit_single_rule(const HymoBatchRule& rule) {
+    switch (rule.op) {
+    case HYMO_BATCH_OP_ADD:
+        return HymoFS::add_rule(rule.src, rule.target, rule.type);
+    case HYMO_BATCH_OP_MERGE:
+        return HymoFS::add_merge_rule(rule.src, rule.target);
+    case HYMO_BATCH_OP_HIDE:
+        return HymoFS::hide_path(rule.src);
+    default:
+        LOG_ERROR("HymoFS: unknown batch op " + std::to_string(rule.op));
         return false;
+    }
+}
 
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(module_dir)) {
-            const fs::path& current_path = entry.path();
+bool HymoFS::add_rules_batch(const std::vector<HymoBatchRule>& rules) {
+    if (rules.empty())
+        return true;
 
-            // Calculate relative path from module root
-            fs::path rel_path = fs::relative(current_path, module_dir);
-            fs::path target_path = target_base / rel_path;
+    if (!(get_features() & HYMO_FEATURE_BULK_RULES)) {
+        LOG_INFO("HymoFS: kernel lacks bulk rule support, submitting " +
+                 std::to_string(rules.size()) + " rules individually");
+        bool ok = true;
+        for (const auto& rule : rules) {
+            ok &= submit_single_rule(rule);
+        }
+        return ok;
+    }
 
-            if (entry.is_regular_file() || entry.is_symlink()) {
-                add_rule(target_path.string(), current_path.string());
-            } else if (entry.is_character_file()) {
-                // Redirection for whiteout (0:0)
-                struct stat st;
-                if (stat(current_path.c_str(), &st) == 0 && st.st_rdev == 0) {
-                    hide_path(target_path.string());
-                }
+    bool ok = true;
+    std::vector<struct hymo_batch_rule> raw;
+    for (size_t offset = 0; offset < rules.size(); offset += HYMO_BULK_MAX_RULES) {
+        size_t count = std::min((size_t)HYMO_BULK_MAX_RULES, rules.size() - offset);
+
+        raw.clear();
+        raw.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            const auto& rule = rules[offset + i];
+            raw.push_back({.src = rule.src.c_str(),
+                           .target = rule.op == HYMO_BATCH_OP_HIDE ? NULL : rule.target.c_str(),
+                           .type = rule.type,
+                           .op = rule.op});
+        }
+
+        struct hymo_syscall_batch_arg arg = {.rules = raw.data(), .count = count};
+        if (hymo_execute_cmd(HYMO_IOC_ADD_RULES_BULK, &arg) == 0) {
+            LOG_INFO("HymoFS: Submitted batch of " + std::to_string(count) + " rules");
+            continue;
+        }
+
+        // Kernel rejected the chunk (e.g. mid-batch validation error);
+        // resubmit this chunk rule-by-rule so one bad entry cannot
+        // discard the rest.
+        LOG_WARN("HymoFS: bulk submission failed: " + std::string(strerror(errno)) +
+                 ", retrying chunk individually");
+        for (size_t i = 0; i < count; i++) {
+            ok &= submit_single_rule(rules[offset + i]);
+        }
+    }
+    return ok;
+}
+
+bool HymoFS::add_rules_from_directory(const fs::path& target_base, const fs::path& module_dir) {
+    if (!fs::exists(module_dir) || !fs::is_directory(module_dir))
+        return false;
+
+    // Collect the whole walk, then submit once: adds and whiteout hides
+    // go through the bulk ioctl instead of one syscall per entry. The
+    // walker's rel path is '/'-prefixed, so the target is one concat.
+    std::vector<HymoBatchRule> batch;
+    std::string target_root = target_base.string();
+    bool walked = walk_directory(module_dir, "", [&](const WalkEntry& e) {
+        if (e.type == DT_REG || e.type == DT_LNK) {
+            batch.push_back({target_root + e.rel, e.path, 0, HYMO_BATCH_OP_ADD});
+        } else if (e.type == DT_CHR) {
+            // Redirection for whiteout (0:0)
+            struct stat st;
+            if (fstatat(e.parent_fd, e.name, &st, AT_SYMLINK_NOFOLLOW) == 0 && st.st_rdev == 0) {
+                batch.push_back({target_root + e.rel, "", 0, HYMO_BATCH_OP_HIDE});
             }
         }
-    } catch (const std::exception& e) {
-        LOG_WARN("HymoFS rule generation error for " + module_dir.string() + ": " + e.what());
+        return WalkControl::Recurse;
+    });
+    if (!walked) {
+        LOG_WARN("HymoFS rule generation: cannot walk " + module_dir.string());
         return false;
     }
-    return true;
+    return add_rules_batch(batch);
 }
 
 bool HymoFS::remove_rules_from_directory(const fs::path& target_base, const fs::path& module_dir) {
@@ -228,31 +337,121 @@ bool HymoFS::remove_rules_from_directory(const fs::path& target_base, const fs::
     return true;
 }
 
-std::string HymoFS::get_active_rules() {
-    size_t buf_size = 16 * 1024;  // 16KB buffer
-    char* raw_buf = (char*)malloc(buf_size);
-    if (!raw_buf) {
-        return "Error: Out of memory\n";
+// Parse one kernel listing line ("add <target> <src>", "merge <target>
+// <src>", "hide <path>", or anything newer) into a structured record
+static HymoActiveRule parse_rule_line(const std::string& line) {
+    HymoActiveRule rule;
+
+    size_t verb_end = line.find(' ');
+    std::string verb = line.substr(0, verb_end);
+    std::transform(verb.begin(), verb.end(), verb.begin(), ::toupper);
+    rule.type = verb;
+
+    std::string rest = verb_end == std::string::npos ? "" : line.substr(verb_end + 1);
+    size_t first = rest.find_first_not_of(' ');
+    rest = first == std::string::npos ? "" : rest.substr(first);
+
+    if (verb == "ADD" || verb == "MERGE") {
+        size_t sep = rest.find(' ');
+        rule.target = rest.substr(0, sep);
+        if (sep != std::string::npos) {
+            size_t src_start = rest.find_first_not_of(' ', sep);
+            if (src_start != std::string::npos) {
+                rule.source = rest.substr(src_start, rest.find(' ', src_start) - src_start);
+            }
+        }
+    } else if (verb == "HIDE") {
+        rule.path = rest.substr(0, rest.find(' '));
+    } else {
+        rule.args = rest;
+    }
+    return rule;
+}
+
+// Stream newline-terminated listing text through the line sink
+static void for_each_line(const char* buf, size_t len,
+                          const std::function<void(const std::string&)>& sink) {
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        if (i == len || buf[i] == '\n') {
+            if (i > start) {
+                sink(std::string(buf + start, i - start));
+            }
+            start = i + 1;
+        }
+    }
+}
+
+// Fetch the listing page by page (HYMO_FEATURE_PAGED_LIST kernels), or
+// via the legacy fixed-buffer ioctl with growing retries. Each filled
+// buffer is handed to `sink` exactly once, so large listings are never
+// concatenated unless the caller wants the full text.
+static bool fetch_rules_raw(const std::function<void(const char*, size_t)>& sink) {
+    if (HymoFS::get_features() & HYMO_FEATURE_PAGED_LIST) {
+        std::vector<char> page(64 * 1024);
+        struct hymo_syscall_list_page_arg arg = {};
+        arg.cursor = 0;
+
+        do {
+            arg.buf = page.data();
+            arg.size = page.size();
+            arg.count = 0;
+            if (hymo_execute_cmd(HYMO_IOC_LIST_RULES_PAGED, &arg) != 0) {
+                LOG_ERROR("HymoFS: paged listing failed: " + std::string(strerror(errno)));
+                return false;
+            }
+            if (arg.size > 0) {
+                sink(page.data(), std::min(arg.size, page.size()));
+            }
+        } while (arg.cursor != 0);
+        return true;
+    }
+
+    // Legacy kernels have no size query; retry with doubled buffers until
+    // the listing fits so large rule sets no longer silently truncate
+    constexpr size_t MAX_LIST_BUF = 64 * 1024 * 1024;
+    for (size_t buf_size = 64 * 1024; buf_size <= MAX_LIST_BUF; buf_size *= 2) {
+        std::vector<char> buf(buf_size, 0);
+        struct hymo_syscall_list_arg arg = {.buf = buf.data(), .size = buf.size()};
+
+        if (hymo_execute_cmd(HYMO_IOC_LIST_RULES, &arg) != 0) {
+            LOG_ERROR("HymoFS: list_rules failed: " + std::string(strerror(errno)));
+            return false;
+        }
+
+        size_t len = strnlen(buf.data(), buf.size());
+        // A listing ending right at capacity was likely cut short
+        if (len + 2 >= buf.size() && buf_size < MAX_LIST_BUF) {
+            LOG_DEBUG("HymoFS: listing filled " + std::to_string(buf_size) +
+                      " byte buffer, retrying larger");
+            continue;
+        }
+        sink(buf.data(), len);
+        return true;
     }
-    memset(raw_buf, 0, buf_size);
+    LOG_WARN("HymoFS: rule listing exceeds maximum buffer, output truncated");
+    return true;
+}
 
-    struct hymo_syscall_list_arg arg = {.buf = raw_buf, .size = buf_size};
+bool HymoFS::list_active_rules(const std::function<void(const HymoActiveRule&)>& sink) {
+    LOG_INFO("HymoFS: Listing active rules...");
+    return fetch_rules_raw([&](const char* buf, size_t len) {
+        for_each_line(buf, len, [&](const std::string& line) { sink(parse_rule_line(line)); });
+    });
+}
 
+std::string HymoFS::get_active_rules() {
     LOG_INFO("HymoFS: Listing active rules...");
-    int ret = hymo_execute_cmd(HYMO_IOC_LIST_RULES, &arg);
-    if (ret < 0) {
+
+    std::string result;
+    if (!fetch_rules_raw([&](const char* buf, size_t len) { result.append(buf, len); })) {
         std::string err = "Error: command failed: ";
         err += strerror(errno);
         err += "\n";
-        LOG_ERROR("HymoFS: get_active_rules failed: " + std::string(strerror(errno)));
-        free(raw_buf);
         return err;
     }
 
-    std::string result(raw_buf);
     LOG_INFO("HymoFS: get_active_rules returned " + std::to_string(result.length()) + " bytes");
-
-    free(raw_buf);
     return result;
 }
 
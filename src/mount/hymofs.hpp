@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <string>
+#include <vector>
 #include "defs.hpp"
 #include "hymo_magic.h"
 
@@ -11,6 +13,25 @@ namespace hymo {
 
 enum class HymoFSStatus { Available, NotPresent, KernelTooOld, ModuleTooOld };
 
+// One pending rule for batched submission (owns its strings so callers
+// can build the vector incrementally without lifetime concerns)
+struct HymoBatchRule {
+    std::string src;
+    std::string target;
+    int type = 0;
+    int op = HYMO_BATCH_OP_ADD;
+};
+
+// One active rule as reported by the kernel listing, parsed from its
+// text line. Unrecognized verbs keep their arguments verbatim in `args`.
+struct HymoActiveRule {
+    std::string type;    // Uppercased verb: ADD, MERGE, HIDE, ...
+    std::string target;  // ADD/MERGE
+    std::string source;  // ADD/MERGE
+    std::string path;    // HIDE
+    std::string args;    // Everything after an unrecognized verb
+};
+
 class HymoFS {
 public:
     static constexpr int EXPECTED_PROTOCOL_VERSION = HYMO_PROTOCOL_VERSION;
@@ -23,13 +44,28 @@ public:
     static bool delete_rule(const std::string& src);
     static bool set_mirror_path(const std::string& path);
     static bool hide_path(const std::string& path);
+    // Deduplicate and submit hide rules in bulk; one ioctl per chunk
+    // instead of one per path
+    static bool hide_paths(const std::vector<std::string>& paths);
     static bool add_merge_rule(const std::string& src, const std::string& target);
 
+    // Batched rule submission - one ioctl per HYMO_BULK_MAX_RULES chunk.
+    // Falls back to per-rule ioctls on kernels without bulk support.
+    static bool add_rules_batch(const std::vector<HymoBatchRule>& rules);
+    static int get_features();
+
     // Helper to recursively walk a directory and generate rules
     static bool add_rules_from_directory(const fs::path& target_base, const fs::path& module_dir);
     static bool remove_rules_from_directory(const fs::path& target_base,
                                             const fs::path& module_dir);
 
+    // Stream the active rule listing through `sink`, one parsed record
+    // per rule. Uses the paged ioctl when the kernel supports it so
+    // arbitrarily large rule sets never truncate; otherwise retries the
+    // fixed-buffer listing with growing buffers. Returns false when the
+    // kernel listing itself failed.
+    static bool list_active_rules(const std::function<void(const HymoActiveRule&)>& sink);
+
     // Debug & Stealth
     static std::string get_active_rules();
     static bool set_debug(bool enable);
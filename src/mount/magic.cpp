@@ -9,15 +9,22 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <set>
 #include <sstream>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include "../core/state.hpp"
 #include "../defs.hpp"
 #include "../utils.hpp"
 #include "mount_utils.hpp"
+#include "overlay.hpp"
 #include "partition_utils.hpp"
 
 #ifndef TMPFS_MAGIC
@@ -26,30 +33,118 @@
 
 namespace hymo {
 
+// Counters are atomics: top-level subtrees mount concurrently and all
+// of them bump these
 struct MountStats {
-    int total_mounts = 0;
-    int successful_mounts = 0;
-    int failed_mounts = 0;
-    int tmpfs_created = 0;
-    int files_mounted = 0;
-    int dirs_mounted = 0;
-    int symlinks_created = 0;
-    int overlayfs_mounts = 0;
+    std::atomic<int> total_mounts{0};
+    std::atomic<int> successful_mounts{0};
+    std::atomic<int> failed_mounts{0};
+    std::atomic<int> tmpfs_created{0};
+    std::atomic<int> files_mounted{0};
+    std::atomic<int> dirs_mounted{0};
+    std::atomic<int> symlinks_created{0};
+    std::atomic<int> overlayfs_mounts{0};
 };
 
 static MountStats g_mount_stats;
 
 enum class NodeFileType { RegularFile, Directory, Symlink, Whiteout };
 
+// Interned string storage: each distinct string is copied once into a
+// bump-allocated block and handed out as a string_view. Names like
+// "lib64" or "etc" and module ids repeat across thousands of nodes, so
+// this removes a heap allocation (and the duplicates) per tree entry.
+class StringPool {
+public:
+    std::string_view intern(std::string_view s) {
+        auto it = index_.find(s);
+        if (it != index_.end()) {
+            return *it;
+        }
+
+        char* dst = alloc(s.size());
+        if (!s.empty()) {
+            memcpy(dst, s.data(), s.size());
+        }
+        std::string_view view(dst, s.size());
+        index_.insert(view);
+        return view;
+    }
+
+private:
+    static constexpr size_t POOL_BLOCK = 64 * 1024;
+
+    char* alloc(size_t n) {
+        if (n > POOL_BLOCK) {
+            blocks_.emplace_back(new char[n]);
+            return blocks_.back().get();
+        }
+        if (used_ + n > cap_) {
+            blocks_.emplace_back(new char[POOL_BLOCK]);
+            active_ = blocks_.back().get();
+            used_ = 0;
+            cap_ = POOL_BLOCK;
+        }
+        char* out = active_ + used_;
+        used_ += n;
+        return out;
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* active_ = nullptr;
+    size_t used_ = 0;
+    size_t cap_ = 0;
+    std::unordered_set<std::string_view> index_;
+};
+
 struct Node {
-    std::string name;
-    NodeFileType file_type;
-    std::unordered_map<std::string, Node> children;
-    fs::path module_path;     // Path to module file
-    std::string module_name;  // Module ID that owns this node
-    bool replace = false;     // Directory marked for replacement (xattr/file)
-    bool skip = false;        // Skip mounting this node
-    bool done = false;        // Already processed flag
+    std::string_view name;  // Interned, owned by the pool
+    NodeFileType file_type = NodeFileType::RegularFile;
+    std::unordered_map<std::string_view, Node*> children;
+    std::string_view module_path;  // Path to module file (interned)
+    std::string_view module_name;  // Module ID that owns this node (interned)
+    bool replace = false;          // Directory marked for replacement (xattr/file)
+    bool skip = false;             // Skip mounting this node
+    bool done = false;             // Already processed flag
+};
+
+// Bump arena for tree nodes: nodes are placement-new'd into fixed
+// chunks, handed around by pointer instead of being copied into maps,
+// and all destroyed together when the mount finishes.
+class NodeArena {
+public:
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    ~NodeArena() {
+        for (auto& chunk : chunks_) {
+            Node* nodes = reinterpret_cast<Node*>(chunk->storage);
+            for (size_t i = 0; i < chunk->used; i++) {
+                nodes[i].~Node();
+            }
+        }
+    }
+
+    Node* create() {
+        if (chunks_.empty() || chunks_.back()->used == CHUNK_NODES) {
+            chunks_.emplace_back(new Chunk());
+        }
+        Chunk& chunk = *chunks_.back();
+        Node* node = new (chunk.storage + chunk.used * sizeof(Node)) Node();
+        chunk.used++;
+        return node;
+    }
+
+private:
+    static constexpr size_t CHUNK_NODES = 512;
+
+    struct Chunk {
+        alignas(alignof(Node)) unsigned char storage[CHUNK_NODES * sizeof(Node)];
+        size_t used = 0;
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;
 };
 
 static bool dir_is_replace(const fs::path& path) {
@@ -84,7 +179,8 @@ static NodeFileType get_file_type(const fs::path& path) {
 }
 
 static bool collect_module_files(Node& node, const fs::path& module_dir,
-                                 const std::string& module_name = "") {
+                                 std::string_view module_name, NodeArena& arena,
+                                 StringPool& pool) {
     if (!fs::exists(module_dir)) {
         LOG_DEBUG("Module dir does not exist: " + module_dir.string());
         return false;
@@ -104,27 +200,27 @@ static bool collect_module_files(Node& node, const fs::path& module_dir,
             std::string name = entry.path().filename().string();
             NodeFileType ft = get_file_type(entry.path());
 
-            auto it = node.children.find(name);
+            auto it = node.children.find(std::string_view(name));
             Node* child = nullptr;
 
             if (it != node.children.end()) {
                 // Node already exists from another module - merge
-                child = &it->second;
+                child = it->second;
             } else {
-                // Create new node
-                Node new_child;
-                new_child.name = name;
-                new_child.file_type = ft;
-                new_child.module_path = entry.path();
-                new_child.module_name = module_name;
-                node.children[name] = new_child;
-                child = &node.children[name];
+                // Create new node in the arena; the map only holds the pointer
+                child = arena.create();
+                child->name = pool.intern(name);
+                child->file_type = ft;
+                child->module_path = pool.intern(entry.path().string());
+                child->module_name = module_name;
+                node.children.emplace(child->name, child);
             }
 
             if (ft == NodeFileType::Directory) {
                 dir_count++;
                 child->replace = dir_is_replace(entry.path());
-                bool child_has_file = collect_module_files(*child, entry.path(), module_name);
+                bool child_has_file =
+                    collect_module_files(*child, entry.path(), module_name, arena, pool);
                 has_file |= child_has_file || child->replace;
                 if (child->replace) {
                     LOG_DEBUG("  Replace dir: " + entry.path().string());
@@ -148,10 +244,15 @@ static bool collect_module_files(Node& node, const fs::path& module_dir,
 }
 
 static Node* collect_all_modules(const std::vector<fs::path>& module_paths,
-                                 const std::vector<std::string>& extra_partitions) {
-    Node* root = new Node{"", NodeFileType::Directory, {}, {}, "", false, false, false};
-    Node system{"system", NodeFileType::Directory, {}, {}, "", false, false, false};
-    system.module_path = "/system";  // Set source for attribute cloning
+                                 const std::vector<std::string>& extra_partitions,
+                                 NodeArena& arena, StringPool& pool) {
+    Node* root = arena.create();
+    root->file_type = NodeFileType::Directory;
+
+    Node* system = arena.create();
+    system->name = pool.intern("system");
+    system->file_type = NodeFileType::Directory;
+    system->module_path = pool.intern("/system");  // Set source for attribute cloning
 
     bool has_file = false;
     std::vector<std::string> failed_modules;
@@ -177,7 +278,8 @@ static Node* collect_all_modules(const std::vector<fs::path>& module_paths,
 
         LOG_INFO("Processing module: " + module_id);
         try {
-            bool module_has_file = collect_module_files(system, module_system, module_id);
+            bool module_has_file =
+                collect_module_files(*system, module_system, pool.intern(module_id), arena, pool);
             has_file |= module_has_file;
             if (module_has_file) {
                 LOG_INFO("  Module " + module_id + " has files to mount");
@@ -195,8 +297,7 @@ static Node* collect_all_modules(const std::vector<fs::path>& module_paths,
 
     if (!has_file) {
         LOG_WARN("No files to magic mount from any module");
-        delete root;
-        return nullptr;
+        return nullptr;  // the arena reclaims everything
     }
 
     LOG_INFO("File collection successful");
@@ -210,21 +311,21 @@ static Node* collect_all_modules(const std::vector<fs::path>& module_paths,
 
         if (fs::is_directory(path_of_root) &&
             (!require_symlink || fs::is_symlink(path_of_system))) {
-            auto it = system.children.find(partition);
-            if (it != system.children.end()) {
-                Node& node = it->second;
-                if (node.file_type == NodeFileType::Symlink) {
-                    if (fs::is_directory(node.module_path)) {
-                        node.file_type = NodeFileType::Directory;
+            auto it = system->children.find(std::string_view(partition));
+            if (it != system->children.end()) {
+                Node* node = it->second;
+                if (node->file_type == NodeFileType::Symlink) {
+                    if (fs::is_directory(fs::path(node->module_path))) {
+                        node->file_type = NodeFileType::Directory;
                     }
                 }
 
-                if (node.module_path.empty()) {
-                    node.module_path = path_of_root;
+                if (node->module_path.empty()) {
+                    node->module_path = pool.intern(path_of_root.string());
                 }
 
-                root->children[partition] = node;
-                system.children.erase(it);
+                root->children[node->name] = node;
+                system->children.erase(it);
             }
         }
     }
@@ -243,23 +344,24 @@ static Node* collect_all_modules(const std::vector<fs::path>& module_paths,
 
         fs::path path_of_root = fs::path("/") / partition;
         if (fs::is_directory(path_of_root)) {
-            auto it = system.children.find(partition);
-            if (it != system.children.end()) {
+            auto it = system->children.find(std::string_view(partition));
+            if (it != system->children.end()) {
                 LOG_DEBUG("attach extra partition '" + partition + "' to root");
-                Node& node = it->second;
-                if (node.file_type == NodeFileType::Symlink && fs::is_directory(node.module_path)) {
-                    node.file_type = NodeFileType::Directory;
+                Node* node = it->second;
+                if (node->file_type == NodeFileType::Symlink &&
+                    fs::is_directory(fs::path(node->module_path))) {
+                    node->file_type = NodeFileType::Directory;
                 }
-                if (node.module_path.empty()) {
-                    node.module_path = path_of_root;
+                if (node->module_path.empty()) {
+                    node->module_path = pool.intern(path_of_root.string());
                 }
-                root->children[partition] = node;
-                system.children.erase(it);
+                root->children[node->name] = node;
+                system->children.erase(it);
             }
         }
     }
 
-    root->children["system"] = system;
+    root->children[system->name] = system;
     return root;
 }
 
@@ -349,13 +451,14 @@ static bool mount_file(const fs::path& path, const fs::path& work_dir_path, cons
     }
 
     if (!node.module_path.empty()) {
-        if (!mount_bind_modern(node.module_path, target_path, true)) {
-            LOG_ERROR("Failed to bind mount file: " + node.module_path.string() + " -> " +
+        fs::path module_path(node.module_path);
+        if (!mount_bind_modern(module_path, target_path, true)) {
+            LOG_ERROR("Failed to bind mount file: " + module_path.string() + " -> " +
                       target_path.string());
             g_mount_stats.failed_mounts++;
             return false;
         }
-        LOG_VERBOSE("Mount file: " + node.module_path.string() + " -> " + target_path.string());
+        LOG_VERBOSE("Mount file: " + module_path.string() + " -> " + target_path.string());
 
         if (!disable_umount) {
             send_unmountable(target_path);
@@ -374,17 +477,18 @@ static bool mount_symlink(const fs::path& work_dir_path, const Node& node) {
 
     if (!node.module_path.empty()) {
         try {
-            auto link_target = fs::read_symlink(node.module_path);
+            fs::path module_path(node.module_path);
+            auto link_target = fs::read_symlink(module_path);
 
             // Validate symlink safety
-            if (!is_safe_symlink(node.module_path, fs::path("/"))) {
-                LOG_ERROR("Unsafe symlink detected: " + node.module_path.string());
+            if (!is_safe_symlink(module_path, fs::path("/"))) {
+                LOG_ERROR("Unsafe symlink detected: " + module_path.string());
                 g_mount_stats.failed_mounts++;
                 return false;
             }
 
             fs::create_symlink(link_target, work_dir_path);
-            clone_attr(node.module_path, work_dir_path);
+            clone_attr(module_path, work_dir_path);
             g_mount_stats.successful_mounts++;
         } catch (...) {
             g_mount_stats.failed_mounts++;
@@ -432,10 +536,10 @@ static bool mount_directory_children(const fs::path& path, const fs::path& work_
         try {
             for (const auto& entry : fs::directory_iterator(path)) {
                 std::string name = entry.path().filename().string();
-                auto it = node.children.find(name);
+                auto it = node.children.find(std::string_view(name));
                 if (it != node.children.end()) {
-                    if (!it->second.skip) {
-                        if (!do_magic_mount(path, work_dir_path, it->second, has_tmpfs,
+                    if (!it->second->skip) {
+                        if (!do_magic_mount(path, work_dir_path, *it->second, has_tmpfs,
                                             disable_umount)) {
                             ok = false;
                         }
@@ -453,13 +557,13 @@ static bool mount_directory_children(const fs::path& path, const fs::path& work_
     }
 
     for (const auto& [name, child_node] : node.children) {
-        if (child_node.skip) {
+        if (child_node->skip) {
             continue;
         }
 
         fs::path real_path = path / name;
         if (!fs::exists(real_path) && !node.replace) {
-            if (!do_magic_mount(path, work_dir_path, child_node, has_tmpfs, disable_umount)) {
+            if (!do_magic_mount(path, work_dir_path, *child_node, has_tmpfs, disable_umount)) {
                 ok = false;
             }
         }
@@ -481,15 +585,15 @@ static bool should_create_tmpfs(const Node& node, const fs::path& path, bool has
         fs::path real_path = path / name;
 
         bool need = false;
-        if (child.file_type == NodeFileType::Symlink) {
+        if (child->file_type == NodeFileType::Symlink) {
             need = true;
-        } else if (child.file_type == NodeFileType::Whiteout) {
+        } else if (child->file_type == NodeFileType::Whiteout) {
             need = fs::exists(real_path);
         } else {
             try {
                 if (fs::exists(real_path)) {
                     NodeFileType real_ft = get_file_type(real_path);
-                    need = (real_ft != child.file_type || real_ft == NodeFileType::Symlink);
+                    need = (real_ft != child->file_type || real_ft == NodeFileType::Symlink);
                 } else {
                     need = true;
                 }
@@ -520,7 +624,7 @@ static bool prepare_tmpfs_dir(const fs::path& path, const fs::path& work_dir_pat
             return false;
         }
 
-        fs::path src_path = fs::exists(path) ? path : node.module_path;
+        fs::path src_path = fs::exists(path) ? path : fs::path(node.module_path);
         clone_attr(src_path, work_dir_path);
 
         mount(work_dir_path.c_str(), work_dir_path.c_str(), nullptr, MS_BIND | MS_REC, nullptr);
@@ -545,6 +649,55 @@ static bool finalize_tmpfs_overlay(const fs::path& path, const fs::path& work_di
     return true;
 }
 
+// True when every node under `node` was contributed by `module_name` and
+// nothing was pruned. Such a subtree is an exact image of the module's
+// on-disk directory, so it can be mounted wholesale.
+static bool subtree_single_module(const Node& node, std::string_view module_name) {
+    for (const auto& [name, child] : node.children) {
+        if (child->skip || child->module_name != module_name) {
+            return false;
+        }
+        if (child->file_type == NodeFileType::Directory &&
+            !subtree_single_module(*child, module_name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Replace directories discard the real content entirely, so when one
+// module owns the whole subtree the result is just that module's
+// directory. Clone it in one open_tree(OPEN_TREE_CLONE|AT_RECURSIVE) +
+// move_mount pair (bind_mount) instead of building a tmpfs skeleton and
+// bind-mounting every entry — a big replace dir collapses from
+// thousands of mount syscalls to one.
+static bool mount_replace_subtree(const fs::path& target_path, const fs::path& target_work_path,
+                                  const Node& node, bool has_tmpfs, bool disable_umount) {
+    fs::path mount_target = has_tmpfs ? target_work_path : target_path;
+
+    if (has_tmpfs) {
+        // Create the mount point inside the skeleton, like any other dir
+        if (!fs::exists(target_work_path)) {
+            fs::create_directory(target_work_path);
+            clone_attr(fs::path(node.module_path), target_work_path);
+        }
+    } else if (!fs::exists(target_path)) {
+        // No real directory to mount over; the tmpfs path handles this
+        return false;
+    }
+
+    if (!bind_mount(fs::path(node.module_path), mount_target, disable_umount)) {
+        return false;
+    }
+
+    mount(nullptr, mount_target.c_str(), nullptr, MS_REMOUNT | MS_RDONLY | MS_BIND, nullptr);
+    g_mount_stats.successful_mounts++;
+
+    LOG_VERBOSE("Cloned replace subtree: " + std::string(node.module_path) + " -> " +
+                mount_target.string());
+    return true;
+}
+
 static bool do_magic_mount(const fs::path& path, const fs::path& work_dir_path, const Node& current,
                            bool has_tmpfs, bool disable_umount) {
     fs::path target_path = path / current.name;
@@ -563,6 +716,22 @@ static bool do_magic_mount(const fs::path& path, const fs::path& work_dir_path,
 
     case NodeFileType::Directory: {
         g_mount_stats.dirs_mounted++;
+
+        // Whole-subtree replacement from a single module: one recursive
+        // clone instead of per-entry binds. Falls through to the tmpfs
+        // path when the clone is not applicable or fails.
+        if (current.replace && !current.module_path.empty() &&
+            subtree_single_module(current, current.module_name)) {
+            g_mount_stats.total_mounts++;
+            if (mount_replace_subtree(target_path, target_work_path, current, has_tmpfs,
+                                      disable_umount)) {
+                return true;
+            }
+            g_mount_stats.total_mounts--;
+            LOG_DEBUG("Subtree clone not applicable for " + target_path.string() +
+                      ", using per-entry mounts");
+        }
+
         bool create_tmpfs = !has_tmpfs && should_create_tmpfs(current, target_path, false);
         bool effective_tmpfs = has_tmpfs || create_tmpfs;
 
@@ -574,7 +743,8 @@ static bool do_magic_mount(const fs::path& path, const fs::path& work_dir_path,
                 }
             } else if (has_tmpfs && !fs::exists(target_work_path)) {
                 fs::create_directory(target_work_path);
-                fs::path src_path = fs::exists(target_path) ? target_path : current.module_path;
+                fs::path src_path =
+                    fs::exists(target_path) ? target_path : fs::path(current.module_path);
                 clone_attr(src_path, target_work_path);
             }
         }
@@ -608,10 +778,78 @@ static bool do_magic_mount(const fs::path& path, const fs::path& work_dir_path,
     return true;
 }
 
+// First-level subtrees (/system, /vendor, ...) have disjoint targets
+// and disjoint skeleton directories, so they mount concurrently on a
+// small pool. The serial path remains for the odd case where the root
+// itself needs a tmpfs skeleton: then the subtrees share one finalize
+// and cannot be split.
+static bool do_magic_mount_root(const fs::path& work_dir, const Node& root, bool disable_umount) {
+    if (should_create_tmpfs(root, "/", false)) {
+        return do_magic_mount("/", work_dir, root, false, disable_umount);
+    }
+
+    std::vector<const Node*> jobs;
+    for (const auto& [name, child] : root.children) {
+        if (!child->skip) {
+            jobs.push_back(child);
+        }
+    }
+    if (jobs.empty()) {
+        return true;
+    }
+    g_mount_stats.dirs_mounted++;  // the root, counted on the serial path too
+
+    size_t workers = std::min(jobs.size(), (size_t)std::thread::hardware_concurrency());
+    if (workers <= 1) {
+        bool ok = true;
+        for (const Node* job : jobs) {
+            if (!do_magic_mount("/", work_dir, *job, false, disable_umount)) {
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    LOG_INFO("Magic mounting " + std::to_string(jobs.size()) + " top-level trees with " +
+             std::to_string(workers) + " workers");
+
+    std::atomic<size_t> next_index{0};
+    std::atomic<bool> ok{true};
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        pool.emplace_back([&]() {
+            while (true) {
+                size_t idx = next_index.fetch_add(1);
+                if (idx >= jobs.size())
+                    break;
+                try {
+                    if (!do_magic_mount("/", work_dir, *jobs[idx], false, disable_umount)) {
+                        ok = false;
+                    }
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Magic mount failed for /" + std::string(jobs[idx]->name) + ": " +
+                              std::string(e.what()));
+                    ok = false;
+                } catch (...) {
+                    LOG_ERROR("Magic mount failed for /" + std::string(jobs[idx]->name));
+                    ok = false;
+                }
+            }
+        });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    return ok;
+}
+
 bool mount_partitions(const fs::path& tmp_path, const std::vector<fs::path>& module_paths,
                       const std::string& mount_source,
                       const std::vector<std::string>& extra_partitions, bool disable_umount) {
-    Node* root = collect_all_modules(module_paths, extra_partitions);
+    NodeArena arena;
+    StringPool pool;
+    Node* root = collect_all_modules(module_paths, extra_partitions, arena, pool);
     if (!root) {
         LOG_INFO("No files to magic mount");
         return true;
@@ -621,7 +859,6 @@ bool mount_partitions(const fs::path& tmp_path, const std::vector<fs::path>& mod
 
     if (!mount_tmpfs(work_dir)) {
         LOG_ERROR("Failed to create workdir tmpfs at " + work_dir.string());
-        delete root;
         return false;
     }
 
@@ -629,7 +866,7 @@ bool mount_partitions(const fs::path& tmp_path, const std::vector<fs::path>& mod
 
     bool result = false;
     try {
-        result = do_magic_mount("/", work_dir, *root, false, disable_umount);
+        result = do_magic_mount_root(work_dir, *root, disable_umount);
     } catch (const std::exception& e) {
         LOG_ERROR("Magic mount failed with exception: " + std::string(e.what()));
         result = false;
@@ -650,8 +887,6 @@ bool mount_partitions(const fs::path& tmp_path, const std::vector<fs::path>& mod
         LOG_WARN("Failed to remove workdir: " + work_dir.string() + ": " + e.what());
     }
 
-    delete root;
-
     save_mount_statistics();
 
     return result;
@@ -732,8 +967,37 @@ void increment_overlay_stats() {
 }
 
 void reset_mount_statistics() {
-    g_mount_stats = MountStats();
+    g_mount_stats.total_mounts = 0;
+    g_mount_stats.successful_mounts = 0;
+    g_mount_stats.failed_mounts = 0;
+    g_mount_stats.tmpfs_created = 0;
+    g_mount_stats.files_mounted = 0;
+    g_mount_stats.dirs_mounted = 0;
+    g_mount_stats.symlinks_created = 0;
+    g_mount_stats.overlayfs_mounts = 0;
     save_mount_statistics();
 }
 
+size_t build_magic_tree_for_bench(const std::vector<fs::path>& module_paths,
+                                  const std::vector<std::string>& extra_partitions) {
+    NodeArena arena;
+    StringPool pool;
+    Node* root = collect_all_modules(module_paths, extra_partitions, arena, pool);
+    if (!root) {
+        return 0;
+    }
+
+    size_t count = 0;
+    std::vector<const Node*> stack = {root};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        count++;
+        for (const auto& [name, child] : node->children) {
+            stack.push_back(child);
+        }
+    }
+    return count;
+}
+
 }  // namespace hymo
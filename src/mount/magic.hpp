@@ -47,4 +47,10 @@ void increment_overlay_stats();
 // Reset mount statistics
 void reset_mount_statistics();
 
+// Build the magic mount node tree without mounting anything and return
+// the node count. Exposed so hymo_bench can measure the tree builder
+// off-device; not used on the mount path.
+size_t build_magic_tree_for_bench(const std::vector<fs::path>& module_paths,
+                                  const std::vector<std::string>& extra_partitions);
+
 }  // namespace hymo
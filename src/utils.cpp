@@ -9,44 +9,170 @@
 #include <sys/syscall.h>
 #include <sys/xattr.h>
 #include <unistd.h>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include "defs.hpp"
+#include "dirwalk.hpp"
 
 namespace hymo {
 
 // Logger implementation
+static const char* level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::Verbose:
+        return "VERBOSE";
+    case LogLevel::Debug:
+        return "DEBUG";
+    case LogLevel::Info:
+        return "INFO";
+    case LogLevel::Warn:
+        return "WARN";
+    case LogLevel::Error:
+        return "ERROR";
+    }
+    return "?";
+}
+
 Logger& Logger::getInstance() {
     static Logger instance;
     return instance;
 }
 
+Logger::Logger() {
+    ring_.reset(new Slot[RING_SIZE]);
+    for (size_t i = 0; i < RING_SIZE; i++) {
+        ring_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    owner_pid_ = getpid();
+    running_.store(true, std::memory_order_release);
+    drain_thread_ = std::thread(&Logger::drain_loop, this);
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
 void Logger::init(bool debug, bool verbose, const fs::path& log_path) {
     debug_ = debug || verbose;
     verbose_ = verbose;
     (void)log_path;
-    log_file_.reset();
 }
 
-void Logger::log(const std::string& level, const std::string& message) {
-    if (level == "VERBOSE" && !verbose_) {
+void Logger::write_record(LogLevel level, time_t ts, const std::string& message) {
+    char time_buf[64];
+    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", std::localtime(&ts));
+
+    std::string log_line =
+        std::string("[") + time_buf + "] [" + level_name(level) + "] " + message + "\n";
+
+    std::cerr << log_line;
+}
+
+void Logger::log(LogLevel level, const std::string& message) {
+    if (level == LogLevel::Verbose && !verbose_) {
         return;
     }
-    if (level == "DEBUG" && !debug_) {
+    if (level == LogLevel::Debug && !debug_) {
         return;
     }
 
-    auto now = std::time(nullptr);
-    char time_buf[64];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    time_t ts = std::time(nullptr);
+
+    // The drain thread does not survive fork(); children (and any caller
+    // racing shutdown) write synchronously instead of enqueueing into a
+    // ring nobody drains
+    if (!running_.load(std::memory_order_acquire) || getpid() != owner_pid_) {
+        write_record(level, ts, message);
+        return;
+    }
 
-    std::string log_line = std::string("[") + time_buf + "] [" + level + "] " + message + "\n";
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = ring_[pos & (RING_SIZE - 1)];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
 
-    std::cerr << log_line;
+        if (dif == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.level = level;
+                slot.ts = ts;
+                slot.message = message;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (dif < 0) {
+            // Ring full: dropping beats stalling the mount hot path; the
+            // drain thread reports the count
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Only pay the wakeup syscall when the drain thread is actually parked
+    if (sleeping_.load(std::memory_order_acquire)) {
+        wake_cv_.notify_one();
+    }
+}
+
+bool Logger::try_dequeue(Slot& out) {
+    Slot& slot = ring_[tail_ & (RING_SIZE - 1)];
+    size_t seq = slot.seq.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(tail_ + 1) < 0) {
+        return false;
+    }
+    out.level = slot.level;
+    out.ts = slot.ts;
+    out.message = std::move(slot.message);
+    slot.seq.store(tail_ + RING_SIZE, std::memory_order_release);
+    tail_++;
+    return true;
+}
+
+void Logger::drain_loop() {
+    Slot record;
+    while (true) {
+        bool drained = false;
+        while (try_dequeue(record)) {
+            write_record(record.level, record.ts, record.message);
+            drained = true;
+        }
+
+        size_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            write_record(LogLevel::Warn, std::time(nullptr),
+                         "Logger: ring full, dropped " + std::to_string(dropped) + " messages");
+        }
+
+        if (!running_.load(std::memory_order_acquire)) {
+            if (!drained) {
+                return;
+            }
+            continue;  // flush whatever raced in during shutdown
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true, std::memory_order_release);
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(200));
+        sleeping_.store(false, std::memory_order_release);
+    }
+}
+
+void Logger::shutdown() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    wake_cv_.notify_one();
+    if (drain_thread_.joinable() && getpid() == owner_pid_) {
+        drain_thread_.join();
+    }
 }
 
 // File system utilities
@@ -140,17 +266,20 @@ bool has_files_recursive(const fs::path& path) {
         return false;
     }
 
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(path)) {
-            if (fs::is_regular_file(entry) || fs::is_symlink(entry)) {
-                return true;
+    bool found = false;
+    if (!walk_directory(path, "", [&](const WalkEntry& e) {
+            if (e.type == DT_REG || e.type == DT_LNK) {
+                found = true;
+                return WalkControl::Stop;
             }
-        }
-    } catch (...) {
+            return WalkControl::Recurse;
+        })) {
+        // Unreadable tree: assume content, like the old iterator did on
+        // a filesystem_error
         return true;
     }
 
-    return false;
+    return found;
 }
 
 // Forward declaration for loop device helper
@@ -171,6 +300,59 @@ bool is_erofs_supported() {
     return false;
 }
 
+// LOOP_CONFIGURE (single-ioctl attach, kernel 5.8+) and direct I/O may be
+// missing from older UAPI headers; carry the definitions ourselves
+#ifndef LOOP_CONFIGURE
+#define LOOP_CONFIGURE 0x4C0A
+struct loop_config {
+    uint32_t fd;
+    uint32_t block_size;
+    struct loop_info64 info;
+    uint64_t __reserved[8];
+};
+#endif
+#ifndef LOOP_SET_DIRECT_IO
+#define LOOP_SET_DIRECT_IO 0x4C08
+#endif
+#ifndef LO_FLAGS_DIRECT_IO
+#define LO_FLAGS_DIRECT_IO 16
+#endif
+
+// Direct I/O on the backing file skips the double page cache (image file
+// + filesystem); configurable because not every backing fs supports it
+static bool g_loop_direct_io = true;
+
+void set_loop_direct_io(bool enabled) {
+    g_loop_direct_io = enabled;
+}
+
+// Attach via LOOP_CONFIGURE: one ioctl instead of SET_FD + SET_STATUS64,
+// with direct I/O requested up front. Returns false on kernels or
+// backing filesystems that don't support it; caller uses the legacy path.
+static bool loop_configure_attach(int loop_fd, int file_fd, bool read_only) {
+    struct loop_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.fd = (uint32_t)file_fd;
+    cfg.info.lo_flags = LO_FLAGS_AUTOCLEAR;
+    if (read_only)
+        cfg.info.lo_flags |= LO_FLAGS_READ_ONLY;
+    if (g_loop_direct_io)
+        cfg.info.lo_flags |= LO_FLAGS_DIRECT_IO;
+
+    if (ioctl(loop_fd, LOOP_CONFIGURE, &cfg) == 0)
+        return true;
+
+    // Direct I/O is the likeliest reason for a refusal; retry without it
+    if (g_loop_direct_io) {
+        cfg.info.lo_flags &= ~(uint32_t)LO_FLAGS_DIRECT_IO;
+        if (ioctl(loop_fd, LOOP_CONFIGURE, &cfg) == 0) {
+            LOG_DEBUG("Loop direct I/O not supported by backing file, attached without it");
+            return true;
+        }
+    }
+    return false;
+}
+
 // Loop device helpers
 static int setup_loop_device(const std::string& image_path, std::string& loop_path,
                              bool read_only) {
@@ -215,13 +397,19 @@ static int setup_loop_device(const std::string& image_path, std::string& loop_pa
         return -1;
     }
 
-    int file_fd = open(image_path.c_str(), read_only ? O_RDONLY : O_RDWR | O_CLOEXEC);
+    int file_fd = open(image_path.c_str(), (read_only ? O_RDONLY : O_RDWR) | O_CLOEXEC);
     if (file_fd < 0) {
         LOG_ERROR("Failed to open image " + image_path + ": " + strerror(errno));
         close(loop_fd);
         return -1;
     }
 
+    if (loop_configure_attach(loop_fd, file_fd, read_only)) {
+        close(file_fd);
+        return loop_fd;
+    }
+
+    // Legacy three-step attach for pre-5.8 kernels
     if (ioctl(loop_fd, LOOP_SET_FD, file_fd) < 0) {
         LOG_ERROR("Failed to bind loop device: " + std::string(strerror(errno)));
         close(file_fd);
@@ -243,6 +431,12 @@ static int setup_loop_device(const std::string& image_path, std::string& loop_pa
         return -1;
     }
 
+    // Best effort on the legacy path; the double page cache is only a
+    // memory/perf cost, not a correctness issue
+    if (g_loop_direct_io && ioctl(loop_fd, LOOP_SET_DIRECT_IO, 1) < 0) {
+        LOG_DEBUG("LOOP_SET_DIRECT_IO not supported: " + std::string(strerror(errno)));
+    }
+
     return loop_fd;
 }
 
@@ -348,6 +542,91 @@ bool repair_image(const fs::path& image_path) {
     return false;
 }
 
+// FICLONE lives in linux/fs.h, which clashes with sys/mount.h
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif  // #ifndef FICLONE
+
+bool copy_file_fast(const fs::path& src, const fs::path& dst) {
+    int src_fd = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(src_fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(src_fd);
+        return false;
+    }
+
+    int dst_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      st.st_mode & 07777);
+    if (dst_fd < 0) {
+        close(src_fd);
+        return false;
+    }
+
+    bool ok = false;
+
+    // Reflink first: free on filesystems that support it, EOPNOTSUPP/EXDEV
+    // otherwise
+    if (ioctl(dst_fd, FICLONE, src_fd) == 0) {
+        ok = true;
+    } else {
+        // copy_file_range keeps the copy entirely in the kernel, sparing
+        // userspace buffers and the page cache double-fill
+        off_t remaining = st.st_size;
+        ok = true;
+        while (remaining > 0) {
+            ssize_t n = syscall(SYS_copy_file_range, src_fd, nullptr, dst_fd, nullptr,
+                                (size_t)remaining, 0);
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            remaining -= n;
+        }
+
+        if (!ok) {
+            // Old kernel or cross-device edge case: plain read/write loop.
+            // A partial copy_file_range advanced both file offsets, so the
+            // destination must rewind too or the loop writes past a
+            // zero-filled hole.
+            if (lseek(src_fd, 0, SEEK_SET) == 0 && lseek(dst_fd, 0, SEEK_SET) == 0 &&
+                ftruncate(dst_fd, 0) == 0) {
+                char buf[64 * 1024];
+                ssize_t n;
+                ok = true;
+                while ((n = read(src_fd, buf, sizeof(buf))) > 0) {
+                    ssize_t off = 0;
+                    while (off < n) {
+                        ssize_t w = write(dst_fd, buf + off, n - off);
+                        if (w < 0) {
+                            ok = false;
+                            break;
+                        }
+                        off += w;
+                    }
+                    if (!ok)
+                        break;
+                }
+                if (n < 0)
+                    ok = false;
+            }
+        }
+    }
+
+    close(src_fd);
+    close(dst_fd);
+
+    if (!ok) {
+        LOG_DEBUG("copy_file_fast failed for " + src.string() + ": " +
+                  std::string(strerror(errno)));
+        unlink(dst.c_str());
+    }
+    return ok;
+}
+
 static bool native_cp_r(const fs::path& src, const fs::path& dst) {
     try {
         LOG_DEBUG("native_cp_r: " + src.string() + " -> " + dst.string());
@@ -376,7 +655,9 @@ static bool native_cp_r(const fs::path& src, const fs::path& dst) {
                 fs::create_symlink(link_target, dst_path);
                 lsetfilecon(dst_path, get_context_for_path(dst_path));
             } else {
-                fs::copy_file(entry.path(), dst_path, fs::copy_options::overwrite_existing);
+                if (!copy_file_fast(entry.path(), dst_path)) {
+                    fs::copy_file(entry.path(), dst_path, fs::copy_options::overwrite_existing);
+                }
                 fs::permissions(dst_path, fs::status(entry.path()).permissions());
                 lsetfilecon(dst_path, get_context_for_path(dst_path));
             }
@@ -529,12 +810,16 @@ struct NukeExt4SysfsCmd {
 
 bool send_unmountable(const fs::path& target) {
 #ifdef __ANDROID__
+    // Concurrent magic mount workers all register paths here
+    static std::mutex sent_mutex;
     static std::set<std::string> sent_unmounts;
 
     std::string path_str = target.string();
     if (path_str.empty())
         return true;
 
+    std::lock_guard<std::mutex> lock(sent_mutex);
+
     // Dedup check
     if (sent_unmounts.find(path_str) != sent_unmounts.end()) {
         return true;
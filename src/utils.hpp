@@ -1,33 +1,92 @@
 // utils.hpp - Utility functions
 #pragma once
 
+#include <sys/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace fs = std::filesystem;
 
 namespace hymo {
 
 // Logging
+enum class LogLevel : int { Verbose = 0, Debug = 1, Info = 2, Warn = 3, Error = 4 };
+
+// Levels below this are stripped at compile time: the macro body is a
+// discarded statement, so the message expression is never evaluated
+#ifndef HYMO_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define HYMO_LOG_MIN_LEVEL 2
+#else
+#define HYMO_LOG_MIN_LEVEL 0
+#endif  // #ifdef NDEBUG
+#endif  // #ifndef HYMO_LOG_MIN_LEVEL
+
+constexpr bool log_level_compiled(LogLevel level) {
+    return (int)level >= HYMO_LOG_MIN_LEVEL;
+}
+
+// Asynchronous logger: callers enqueue into a lock-free bounded ring and a
+// background thread formats and writes, so hot paths (one LOG_INFO per
+// HymoFS rule) pay an enqueue instead of strftime + a cerr write. Falls
+// back to a synchronous write before the drain thread exists, after
+// shutdown, and in forked children.
 class Logger {
 public:
     static Logger& getInstance();
     void init(bool debug, bool verbose, const fs::path& log_path);
-    void log(const std::string& level, const std::string& message);
+    void log(LogLevel level, const std::string& message);
+    // Drain outstanding records and stop the background thread
+    void shutdown();
 
 private:
-    Logger() = default;
+    struct Slot {
+        std::atomic<size_t> seq;
+        LogLevel level;
+        time_t ts;
+        std::string message;
+    };
+
+    static constexpr size_t RING_SIZE = 1024;  // power of two
+
+    Logger();
+    ~Logger();
+    void drain_loop();
+    bool try_dequeue(Slot& out);
+    static void write_record(LogLevel level, time_t ts, const std::string& message);
+
     bool debug_ = false;
     bool verbose_ = false;
-    std::unique_ptr<std::ofstream> log_file_;
+    pid_t owner_pid_ = 0;
+    std::unique_ptr<Slot[]> ring_;
+    std::atomic<size_t> head_{0};
+    size_t tail_ = 0;  // drain thread only
+    std::atomic<size_t> dropped_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> sleeping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::thread drain_thread_;
 };
 
-#define LOG_INFO(msg) Logger::getInstance().log("INFO", msg)
-#define LOG_WARN(msg) Logger::getInstance().log("WARN", msg)
-#define LOG_ERROR(msg) Logger::getInstance().log("ERROR", msg)
-#define LOG_DEBUG(msg) Logger::getInstance().log("DEBUG", msg)
-#define LOG_VERBOSE(msg) Logger::getInstance().log("VERBOSE", msg)
+#define HYMO_LOG_AT(lvl, msg)                               \
+    do {                                                    \
+        if constexpr (::hymo::log_level_compiled(lvl)) {    \
+            ::hymo::Logger::getInstance().log(lvl, msg);    \
+        }                                                   \
+    } while (0)
+
+#define LOG_INFO(msg) HYMO_LOG_AT(::hymo::LogLevel::Info, msg)
+#define LOG_WARN(msg) HYMO_LOG_AT(::hymo::LogLevel::Warn, msg)
+#define LOG_ERROR(msg) HYMO_LOG_AT(::hymo::LogLevel::Error, msg)
+#define LOG_DEBUG(msg) HYMO_LOG_AT(::hymo::LogLevel::Debug, msg)
+#define LOG_VERBOSE(msg) HYMO_LOG_AT(::hymo::LogLevel::Verbose, msg)
 
 // File system utilities
 bool ensure_dir_exists(const fs::path& path);
@@ -38,11 +97,17 @@ std::string get_context_for_path(const fs::path& path);
 bool copy_path_context(const fs::path& src, const fs::path& dst);
 
 bool mount_tmpfs(const fs::path& target);
+// Whether image loop devices are attached with direct I/O (default on);
+// wired to the loop_direct_io config option
+void set_loop_direct_io(bool enabled);
 bool mount_image(const fs::path& image_path, const fs::path& target,
                  const std::string& fs_type = "ext4",
                  const std::string& options = "loop,rw,noatime");
 bool repair_image(const fs::path& image_path);
 bool sync_dir(const fs::path& src, const fs::path& dst);
+// Kernel-side file copy: FICLONE reflink, then copy_file_range, then a
+// read/write loop as last resort
+bool copy_file_fast(const fs::path& src, const fs::path& dst);
 bool has_files_recursive(const fs::path& path);
 bool check_tmpfs_xattr();
 